@@ -6,9 +6,11 @@ layout(location = 1) in vec2 texCoord;
 
 out vec2 v_TexCoord;
 
+uniform mat4 u_MVP;
+
 void main()
 {
-	gl_Position = position;
+	gl_Position = u_MVP * position;
 	v_TexCoord = texCoord;
 };
 
@@ -24,6 +26,10 @@ uniform sampler2D u_Texture;
 
 void main()
 {
+#ifdef TEXTURED
 	vec4 texColor = texture(u_Texture, v_TexCoord);
 	color = texColor;
+#else
+	color = u_Color;
+#endif
 };
\ No newline at end of file
@@ -0,0 +1,31 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in float texLayer;
+
+out vec2 v_TexCoord;
+flat out float v_TexLayer;
+
+void main()
+{
+	gl_Position = position;
+	v_TexCoord = texCoord;
+	v_TexLayer = texLayer;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+flat in float v_TexLayer;
+
+uniform sampler2DArray u_Textures;
+
+void main()
+{
+	color = texture(u_Textures, vec3(v_TexCoord, v_TexLayer));
+};
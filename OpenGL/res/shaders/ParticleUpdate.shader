@@ -0,0 +1,27 @@
+#shader compute
+#version 430 core
+
+layout(local_size_x = 64) in;
+
+struct Particle
+{
+	vec2 position;
+	vec2 velocity;
+};
+
+layout(std430, binding = 0) buffer Particles
+{
+	Particle particles[];
+};
+
+uniform int u_Count;
+uniform float u_DeltaTime;
+
+void main()
+{
+	uint i = gl_GlobalInvocationID.x;
+	if (i >= uint(u_Count))
+		return;
+
+	particles[i].position += particles[i].velocity * u_DeltaTime;
+};
@@ -1,22 +1,305 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <fstream>
+#include <iterator>
+#include <memory>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include "Renderer.h"
+#include "AsyncReadback.h"
+#include "Framebuffer.h"
+#include "FixedTimestep.h"
+#include "FrameCapture.h"
+#include "FramePacer.h"
+#include "Hash.h"
+#include "ImageArena.h"
+#include "JobSystem.h"
+#include "Math.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 #include "IndexBuffer.h"
+#include "Scene.h"
 #include "VertexArray.h"
 #include "Shader.h"
+#include "ShaderStorageBuffer.h"
+#include "ShaderLibrary.h"
+#include "ShaderVariants.h"
 #include "Texture.h"
+#include "TextureAtlas.h"
+#include "TextureCompression.h"
+#include "TextureStreamer.h"
+#include "vendor\stb_image\stb_image.h"
 
+// "OpenGL --job-benchmark": how a ParallelFor and a flood of tiny jobs scale
+// from one thread up to one per core.
+static int RunJobBenchmark()
+{
+	typedef std::chrono::steady_clock Clock;
+	std::vector<float> data(1 << 22, 1.0f);
+	auto work = [&data](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+			data[i] = std::sqrt(data[i] * 1.0001f + 1.0f);
+	};
+	const int repeats = 20;
+
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < repeats; i++)
+		work(0, (unsigned int)data.size());
+	double serial = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	std::cout << "1 thread (no jobs): " << serial << " ms" << std::endl;
+
+	unsigned int cores = std::thread::hardware_concurrency();
+	for (unsigned int threads = 2; threads <= (cores > 2 ? cores : 2); threads++)
+	{
+		JobSystem jobs(threads);
+		start = Clock::now();
+		for (int i = 0; i < repeats; i++)
+			jobs.ParallelFor((unsigned int)data.size(), 16384, work);
+		double parallel = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		const int count = 1000000;
+		JobCounter empty;
+		start = Clock::now();
+		for (int i = 0; i < count; i++)
+			jobs.Run(empty, [] {});
+		jobs.Wait(empty);
+		double overhead = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+
+		std::cout << threads << " threads: " << parallel << " ms, " << serial / parallel << "x; "
+			<< overhead << " ns per empty job" << std::endl;
+	}
+	return 0;
+}
+
+// "OpenGL --math-benchmark": batch transform throughput, the SIMD kernels
+// against the plain C++ reference.
+static int RunMathBenchmark()
+{
+	typedef std::chrono::steady_clock Clock;
+	const unsigned int count = 1 << 20;
+	const int repeats = 20;
+	std::vector<float> x(count, 1.0f), y(count, 2.0f), z(count, 3.0f), outX(count), outY(count), outZ(count);
+	std::vector<Mat4> matrices(count / 16, Mat4::FromTRS({ 1.0f, 2.0f, 3.0f }, Quat::FromAxisAngle({ 0.0f, 1.0f, 0.0f }, 0.5f), { 2.0f, 2.0f, 2.0f }));
+	std::vector<Mat4> products(matrices.size());
+	Mat4 viewProjection = Mat4::Perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f) * Mat4::LookAt({ 0.0f, 2.0f, 5.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+
+	auto time = [repeats](const std::function<void()>& run)
+	{
+		Clock::time_point start = Clock::now();
+		for (int i = 0; i < repeats; i++)
+			run();
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / repeats;
+	};
+
+	double scalar = time([&] { Math::TransformPointsScalar(viewProjection, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), count); });
+	double simd = time([&] { Math::TransformPoints(viewProjection, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), count); });
+	std::cout << "Transform " << count << " points: scalar " << count / scalar / 1000.0 << " M/s, SIMD "
+		<< count / simd / 1000.0 << " M/s (" << scalar / simd << "x)" << std::endl;
+
+	unsigned int multiplies = (unsigned int)matrices.size();
+	scalar = time([&] { Math::MultiplyScalar(viewProjection, matrices.data(), products.data(), multiplies); });
+	simd = time([&] { Math::Multiply(viewProjection, matrices.data(), products.data(), multiplies); });
+	std::cout << "Multiply " << multiplies << " matrices: scalar " << multiplies / scalar / 1000.0 << " M/s, SIMD "
+		<< multiplies / simd / 1000.0 << " M/s (" << scalar / simd << "x)" << std::endl;
+	return 0;
+}
+
+// "OpenGL --compute-benchmark": res/shaders/ParticleUpdate.shader stepping a
+// million particles on the GPU against the same loop on the CPU. Needs a 4.3
+// context, which Mesa's llvmpipe provides where there is no GPU.
+static int RunComputeBenchmark()
+{
+	typedef std::chrono::steady_clock Clock;
+	const unsigned int count = 1 << 20;
+	const int steps = 100;
+	const float deltaTime = 1.0f / 60.0f;
+
+	struct Particle
+	{
+		float Position[2];
+		float Velocity[2];
+	};
+	std::vector<Particle> particles(count);
+	for (unsigned int i = 0; i < count; i++)
+		particles[i] = { { (float)(i % 1024), (float)(i / 1024) }, { std::sin(i * 0.01f), std::cos(i * 0.01f) } };
+
+	if (!glfwInit())
+		return 1;
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "Compute benchmark", NULL, NULL);
+	if (!window)
+	{
+		std::cout << "Error: no OpenGL 4.3 context for the compute benchmark" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	if (glewInit() != GLEW_OK || !Renderer::IsComputeSupported())
+	{
+		std::cout << "Error: compute shaders are not supported by " << glGetString(GL_RENDERER) << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+	std::cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << std::endl;
+
+	bool match = false;
+	do
+	{ // The GL objects have to go before the context.
+		Shader shader("res/shaders/ParticleUpdate.shader");
+		if (!shader.IsReady() || !shader.IsCompute())
+		{
+			std::cout << "Failed to build res/shaders/ParticleUpdate.shader" << std::endl;
+			break;
+		}
+		shader.Bind();
+		shader.SetUniform1i("u_Count", (int)count);
+		shader.SetUniform1f("u_DeltaTime", deltaTime);
+
+		Renderer renderer;
+		ShaderStorageBuffer buffer(particles.data(), count * sizeof(Particle));
+		buffer.BindBase(0);
+		GLCall(glFinish());
+
+		Clock::time_point start = Clock::now();
+		for (int step = 0; step < steps; step++)
+		{
+			renderer.DispatchInvocations(shader, count);
+			renderer.Barrier(step + 1 < steps ? GL_SHADER_STORAGE_BARRIER_BIT : GL_BUFFER_UPDATE_BARRIER_BIT);
+		}
+		GLCall(glFinish());
+		double gpu = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		std::vector<Particle> result(count);
+		start = Clock::now();
+		buffer.GetData(result.data(), count * sizeof(Particle));
+		double download = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		start = Clock::now();
+		for (int step = 0; step < steps; step++)
+		{
+			for (unsigned int i = 0; i < count; i++)
+			{
+				particles[i].Position[0] += particles[i].Velocity[0] * deltaTime;
+				particles[i].Position[1] += particles[i].Velocity[1] * deltaTime;
+			}
+		}
+		double cpu = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
 
-int main(void)
+		// The GPU may fuse the multiply-add, so allow a little rounding per step.
+		float maxError = 0.0f;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			for (int axis = 0; axis < 2; axis++)
+			{
+				float error = std::fabs(result[i].Position[axis] - particles[i].Position[axis]) / (1.0f + std::fabs(particles[i].Position[axis]));
+				maxError = error > maxError ? error : maxError;
+			}
+		}
+		match = maxError < 1e-4f;
+
+		std::cout << "Update " << count << " particles x " << steps << " steps: GPU " << gpu << " ms (+" << download
+			<< " ms readback), CPU " << cpu << " ms (" << cpu / gpu << "x)" << std::endl;
+		std::cout << "Largest relative difference " << maxError << (match ? ", results match" : ", results DIFFER") << std::endl;
+	} while (false);
+
+	glfwTerminate();
+	return match ? 0 : 1;
+}
+
+// "OpenGL --decode-benchmark [file.png ...]": PNG decode time with the SIMD
+// row defilter and with the scalar loops, plus a checksum of the pixels that
+// has to come out the same both ways. Files are read into memory first so
+// only decoding is timed.
+static int RunDecodeBenchmark(const std::vector<std::string>& paths)
 {
+	typedef std::chrono::steady_clock Clock;
+	const int repeats = 10;
+	bool match = true;
+
+	for (const std::string& path : paths)
+	{
+		std::ifstream file(path, std::ios::binary);
+		std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (bytes.empty())
+		{
+			std::cout << "Failed to read '" << path << "'" << std::endl;
+			match = false;
+			continue;
+		}
+
+		double times[2];
+		unsigned long long checksums[2] = { 0, 0 };
+		int width = 0, height = 0, channels = 0;
+		for (int simd = 0; simd < 2; simd++)
+		{
+			stbi_set_png_simd_defilter(simd);
+			Clock::time_point start = Clock::now();
+			for (int i = 0; i < repeats; i++)
+			{
+				unsigned char* pixels = stbi_load_from_memory(bytes.data(), (int)bytes.size(), &width, &height, &channels, 0);
+				if (!pixels)
+					break;
+				if (i == 0)
+					checksums[simd] = HashBytes(pixels, (size_t)width * height * channels);
+				stbi_image_free(pixels);
+				ImageArena::Reset();
+			}
+			times[simd] = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / repeats;
+		}
+		stbi_set_png_simd_defilter(1);
+
+		if (checksums[0] == 0)
+		{
+			std::cout << "Failed to decode '" << path << "': " << stbi_failure_reason() << std::endl;
+			match = false;
+			continue;
+		}
+		match = match && checksums[0] == checksums[1];
+		std::cout << path << " (" << width << "x" << height << "x" << channels << "): scalar " << times[0] << " ms, SIMD "
+			<< times[1] << " ms (" << times[0] / times[1] << "x), checksum " << std::hex << checksums[0] << " / " << checksums[1]
+			<< std::dec << (checksums[0] == checksums[1] ? "" : " DIFFERENT") << std::endl;
+	}
+	return match ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+	// Offline tool: "OpenGL --compress res/textures/japan.png ..." writes a
+	// BC1/BC3 .dds next to every image and exits without opening a window.
+	if (argc > 1 && std::string(argv[1]) == "--compress")
+	{
+		bool ok = true;
+		for (int i = 2; i < argc; i++)
+			ok = TextureCompression::CompressFile(argv[i]) && ok;
+		return ok ? 0 : 1;
+	}
+	if (argc > 1 && std::string(argv[1]) == "--job-benchmark")
+		return RunJobBenchmark();
+	if (argc > 1 && std::string(argv[1]) == "--math-benchmark")
+		return RunMathBenchmark();
+	if (argc > 1 && std::string(argv[1]) == "--compute-benchmark")
+		return RunComputeBenchmark();
+	if (argc > 1 && std::string(argv[1]) == "--decode-benchmark")
+	{
+		std::vector<std::string> paths(argv + 2, argv + argc);
+		if (paths.empty())
+			paths = { "res/textures/japan.png", "res/textures/Msd.png" };
+		return RunDecodeBenchmark(paths);
+	}
+
 	GLFWwindow* window;
 
 	/* Initialize the library */
@@ -42,8 +325,6 @@ int main(void)
 	std::cout << glGetString(GL_RENDERER) << std::endl;
 	std::cout << glGetString(GL_VERSION) << std::endl;
 
-	glfwSwapInterval(1);
-
 	if (glewInit() != GLEW_OK) {
 		std::cout << "GLEW ERROR!\n";
 	}
@@ -69,6 +350,14 @@ int main(void)
 		GLCall(glEnable(GL_BLEND));
 		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
 
+		ShaderLibrary shaders;
+		shaders.EnableBinaryCache("res/shaders/cache");
+
+		ShaderVariants basicShader(shaders, "Basic", "res/shaders/Basic.shader", { "TEXTURED" });
+		Shader& shader = *basicShader.Get(basicShader.GetKeywordMask("TEXTURED"));
+		shaders.WaitAll(); // Startup needs it right away to set the uniforms below.
+		shaders.EnableHotReload(true);
+
 		VertexArray va;
 		// Create a Vertex Buffer
 		VertexBuffer vb(positions, 4 * 4 * sizeof(float));
@@ -77,18 +366,40 @@ int main(void)
 		VertexBufferLayout layout;
 		layout.Push<float>(2);
 		layout.Push<float>(2);
-		va.AddBuffer(vb, layout);
+		va.AddBuffer(vb, layout, &shader); // Checked against the shader, also after a reload
 		
 		/* INDEX BUFFER OBJECT - Renderizando utilizando indexes para economizar memoria*/
 		IndexBuffer ib(indices, 6);
 
-		Shader shader("res/shaders/Basic.shader");
+		UniformHandle colorUniform = shader.GetUniformHandle("u_Color");
 		shader.Bind();
-		shader.SetUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
+		shader.SetUniform4f(colorUniform, 0.8f, 0.3f, 0.8f, 1.0f);
 
-		Texture texture("res/textures/japan.png");
-		texture.Bind();
+		JobSystem jobs;
+		TextureStreamer textures(jobs);
+		std::shared_ptr<Texture> texture = textures.Load("res/textures/japan.png");
 		shader.SetUniform1i("u_Texture", 0);
+
+		// Sprites share one atlas page; the constructor reports how well it packed.
+		TextureAtlas sprites({ "res/textures/japan.png", "res/textures/Msd.png" }, 1024);
+
+		// The quad fills the middle of the window; a smaller copy hangs off its
+		// top right corner and follows it.
+		Scene entities;
+		RenderComponent quad;
+		quad.Vertices = &va;
+		quad.Indices = &ib;
+		quad.Material = &shader;
+		quad.Albedo = texture.get();
+		const AABB quadBounds = { { -0.5f, -0.5f, 0.0f }, { 0.5f, 0.5f, 0.0f } };
+		Entity root = entities.Create();
+		entities.SetRenderable(root, quad);
+		entities.SetBounds(root, quadBounds);
+		Entity corner = entities.Create(root);
+		entities.SetPosition(corner, { 0.5f, 0.5f, 0.0f });
+		entities.SetScale(corner, { 0.25f, 0.25f, 1.0f });
+		entities.SetRenderable(corner, quad);
+		entities.SetBounds(corner, quadBounds);
 		
 		// Unbinding everything
 		va.Unbind();
@@ -98,35 +409,206 @@ int main(void)
 
 		Renderer renderer;
 
-		float redChannel = 0.0f;
+		// The scene is drawn 4x multisampled and resolved into the window.
+		FramebufferSpec sceneSpec;
+		glfwGetFramebufferSize(window, &sceneSpec.Width, &sceneSpec.Height);
+		sceneSpec.Samples = 4;
+		sceneSpec.Colors.push_back(FramebufferAttachment(GL_RGBA8));
+		sceneSpec.DepthStencil = FramebufferAttachment(GL_DEPTH24_STENCIL8, false, false);
+		Framebuffer scene(sceneSpec);
+
+		// "--capture run.y4m" (or run.raw, or a prefix for a PNG sequence) records
+		// every frame for offline review. "--present vsync|adaptive|off" and
+		// "--fps N" pace the loop; "--on-demand" only draws when something changed.
+		// "--readback-benchmark [frames]" draws that many frames without vsync
+		// once loading is done, then as many reading each one back, prints the
+		// two average frame times and quits.
+		std::unique_ptr<FrameCapture> capture;
+		FramePacer pacer(window);
+		unsigned int benchmarkFrames = 0;
+		for (int i = 1; i < argc; i++)
+		{
+			std::string arg = argv[i];
+			if (arg == "--capture" && i + 1 < argc)
+			{
+				std::string path = argv[++i];
+				std::string extension = path.size() > 4 ? path.substr(path.size() - 4) : "";
+				CaptureFormat format = extension == ".y4m" ? CaptureFormat::Y4M : extension == ".raw" ? CaptureFormat::Raw : CaptureFormat::PNG;
+				capture.reset(new FrameCapture(path, format));
+			}
+			else if (arg == "--present" && i + 1 < argc)
+			{
+				std::string mode = argv[++i];
+				pacer.SetPresentMode(mode == "off" ? PresentMode::Off : mode == "adaptive" ? PresentMode::Adaptive : PresentMode::VSync);
+			}
+			else if (arg == "--fps" && i + 1 < argc)
+				pacer.SetFrameLimit(std::atof(argv[++i]));
+			else if (arg == "--on-demand")
+				pacer.SetRenderOnDemand(true);
+			else if (arg == "--readback-benchmark")
+			{
+				benchmarkFrames = i + 1 < argc && std::atoi(argv[i + 1]) > 0 ? (unsigned int)std::atoi(argv[++i]) : 500;
+				pacer.SetPresentMode(PresentMode::Off);
+			}
+		}
+
+		// R toggles reading every frame back, to compare frame times with it on and off.
+		AsyncReadback readback;
+		bool readbackEnabled = false, readbackKeyDown = false;
+		unsigned int framesReadBack = 0;
+		unsigned int benchmarkFrame = 0;
+		double benchmarkStart = 0.0, benchmarkWithout = 0.0;
+		// Space pauses the animation, which lets render-on-demand go idle.
+		bool paused = false, pauseKeyDown = false;
+		bool loading = true;
+
+		// The color animates at a fixed 60 steps per second whatever the frame rate.
+		FixedTimestep timestep(1.0 / 60.0);
+		float redChannel = 0.0f, previousRedChannel = 0.0f;
 		float redChannelIncrement = 0.05f;
+		float angle = 0.0f, previousAngle = 0.0f; // The quad turns once every 10 seconds.
+		double statsTime = glfwGetTime();
+		unsigned int frames = 0;
 
 		/* Loop until the user closes the window */
 		while (!glfwWindowShouldClose(window))
 		{
-			
-			/* RENDER HERE */
+			shaders.Poll();
 
-			renderer.Clear();
-			
-			shader.Bind();
-			shader.SetUniform4f("u_Color", redChannel, 0.3f, 0.8f, 1.0f);
+			for (unsigned int steps = timestep.Advance(glfwGetTime()); steps > 0 && !paused; steps--)
+			{
+				pacer.RequestRedraw();
+				previousRedChannel = redChannel;
+				previousAngle = angle;
+				angle += 2.0f * 3.14159265f / 600.0f;
+				if (angle > 2.0f * 3.14159265f)
+				{
+					angle -= 2.0f * 3.14159265f;
+					previousAngle -= 2.0f * 3.14159265f;
+				}
+				if (redChannel > 1.0f)
+					redChannelIncrement = -0.05f;
+				else if (redChannel < 0.0f)
+					redChannelIncrement = 0.05f;
+
+				redChannel += redChannelIncrement;
+			}
+			if (paused)
+			{
+				previousRedChannel = redChannel;
+				previousAngle = angle;
+			}
+			// Between the last two steps, so motion stays smooth at any refresh rate.
+			float renderRedChannel = previousRedChannel + (redChannel - previousRedChannel) * timestep.GetAlpha();
+			float renderAngle = previousAngle + (angle - previousAngle) * timestep.GetAlpha();
+			entities.SetRotation(root, Quat::FromAxisAngle({ 0.0f, 0.0f, 1.0f }, renderAngle));
+
+			// The quad is a unit square; the camera shows two units of height.
+			int width, height;
+			glfwGetFramebufferSize(window, &width, &height);
+			textures.SetScreenSize(texture, 0.5f * height);
+			float aspect = height > 0 ? (float)width / height : 1.0f;
+			Mat4 projection = Mat4::Orthographic(-aspect, aspect, -1.0f, 1.0f, -1.0f, 1.0f);
+			textures.Update();
+
+			// One more frame after loading finishes, to show the final result.
+			bool wasLoading = loading;
+			loading = shaders.GetPendingCount() > 0 || textures.GetPendingCount() > 0;
+			if (loading || wasLoading || readbackEnabled || readback.GetPendingCount() > 0 || capture)
+				pacer.RequestRedraw();
+
+			if (pacer.ShouldRender())
+			{
+				Shader::ResetUniformStats();
+
+				/* RENDER HERE */
+
+				GLCall(glViewport(0, 0, width, height));
+				scene.Resize(width, height);
+				renderer.SetTarget(&scene);
+				renderer.Clear();
 			
-			renderer.Draw(va, ib, shader);
+				shader.Bind();
+				shader.SetUniform4f(colorUniform, renderRedChannel, 0.3f, 0.8f, 1.0f);
+
+				// The texture starts as a placeholder, then sharpens as levels stream in.
+				entities.UpdateTransforms(&jobs);
+				renderer.Submit(entities, projection);
+
+				scene.Resolve(nullptr);
+				scene.Invalidate(); // Depth and stencil aren't needed past this point.
+				renderer.SetTarget(nullptr);
+
+				// Nothing to read while minimized.
+				bool visible = width > 0 && height > 0;
+				if (readbackEnabled && visible)
+					readback.Request(nullptr, 0, 0, width, height, [&framesReadBack](const ReadbackFrame&) { framesReadBack++; });
+				readback.Poll();
+				if (capture && visible)
+					capture->Capture(nullptr, width, height);
+				frames++;
 
-			if (redChannel > 1.0f)
-				redChannelIncrement = -0.05f;
-			else if (redChannel < 0.0f)
-				redChannelIncrement = 0.05f;
+				// Frame time, uniform calls of the last frame and texture memory, refreshed once a second.
+				if (glfwGetTime() - statsTime >= 1.0)
+				{
+					const UniformStats& stats = Shader::GetUniformStats();
+					std::stringstream title;
+					title << "Hello World | " << (glfwGetTime() - statsTime) * 1000.0 / frames << " ms";
+					if (pacer.IsRenderOnDemand())
+						title << " (" << pacer.GetSkippedFrames() << " skipped)";
+					if (readbackEnabled)
+						title << " (readback " << framesReadBack << " read, " << readback.GetDroppedCount() << " dropped)";
+					if (capture)
+					{
+						FrameCaptureStats captured = capture->GetStats();
+						title << " | capture " << captured.Written << " written, " << captured.Dropped << " dropped";
+					}
+					title << " | uniforms set " << stats.Set << ", skipped " << stats.Skipped << " | textures";
+					for (const auto& format : Texture::GetMemoryByFormat())
+						title << " " << Texture::GetFormatName(format.first) << " " << format.second / 1024 << " KB";
+					const ImageArenaStats& decode = texture->GetDecodeStats();
+					title << " | decode " << decode.Allocations << " allocs, peak " << decode.PeakBytes / 1024 << " KB";
+					glfwSetWindowTitle(window, title.str().c_str());
+					statsTime = glfwGetTime();
+					frames = 0;
+				}
 
-			redChannel += redChannelIncrement;
+				/* Swap front and back buffers */
+				glfwSwapBuffers(window);
 
+				if (benchmarkFrames > 0 && !loading)
+				{
+					if (benchmarkFrame == 0)
+						benchmarkStart = glfwGetTime();
+					else if (benchmarkFrame == benchmarkFrames)
+					{
+						benchmarkWithout = (glfwGetTime() - benchmarkStart) * 1000.0 / benchmarkFrames;
+						readbackEnabled = true;
+						benchmarkStart = glfwGetTime();
+					}
+					else if (benchmarkFrame == 2 * benchmarkFrames)
+					{
+						double with = (glfwGetTime() - benchmarkStart) * 1000.0 / benchmarkFrames;
+						std::cout << benchmarkFrames << " frames at " << width << "x" << height << ": " << benchmarkWithout
+							<< " ms without readback, " << with << " ms with (" << framesReadBack << " read, "
+							<< readback.GetDroppedCount() << " dropped)" << std::endl;
+						glfwSetWindowShouldClose(window, GLFW_TRUE);
+					}
+					benchmarkFrame++;
+				}
+			}
 
-			/* Swap front and back buffers */
-			glfwSwapBuffers(window);
+			/* Poll for and process events, waiting for them while idle */
+			pacer.EndFrame();
 
-			/* Poll for and process events */
-			glfwPollEvents();
+			bool readbackKey = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+			if (readbackKey && !readbackKeyDown)
+				readbackEnabled = !readbackEnabled;
+			readbackKeyDown = readbackKey;
+			bool pauseKey = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+			if (pauseKey && !pauseKeyDown)
+				paused = !paused;
+			pauseKeyDown = pauseKey;
 		}
 	} // End of the big scope.
 
@@ -0,0 +1,117 @@
+#include "AsyncReadback.h"
+
+#include "Framebuffer.h"
+#include "Renderer.h"
+
+AsyncReadback::AsyncReadback(unsigned int ringSize)
+	: m_Slots(ringSize), m_Next(0), m_Oldest(0), m_InFlight(0), m_Frame(0), m_Dropped(0)
+{
+	for (Slot& slot : m_Slots)
+	{
+		GLCall(glGenBuffers(1, &slot.Buffer));
+		slot.Size = 0;
+		slot.Fence = nullptr;
+	}
+}
+
+AsyncReadback::~AsyncReadback()
+{
+	for (Slot& slot : m_Slots)
+	{
+		if (slot.Fence)
+		{
+			GLCall(glDeleteSync(slot.Fence));
+		}
+		GLCall(glDeleteBuffers(1, &slot.Buffer));
+	}
+}
+
+bool AsyncReadback::Request(const Framebuffer* source, int x, int y, int width, int height, Callback onReady)
+{
+	// A minimized window is 0x0; there is nothing to read and no store to map.
+	if (width <= 0 || height <= 0)
+		return false;
+
+	if (m_InFlight == m_Slots.size())
+	{
+		m_Dropped++;
+		return false;
+	}
+
+	Slot& slot = m_Slots[m_Next];
+	m_Next = (m_Next + 1) % m_Slots.size();
+	m_InFlight++;
+
+	unsigned int size = width * height * 4;
+	GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer));
+	if (size > slot.Size)
+	{
+		GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ));
+		slot.Size = size;
+	}
+
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, source ? source->GetRendererID() : 0));
+	GLCall(glReadBuffer(source ? GL_COLOR_ATTACHMENT0 : GL_BACK));
+	// With a pack buffer bound the copy is queued on the GPU; the last
+	// argument is an offset into the buffer.
+	GLCall(glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, 0));
+	GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+	GLCall(slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	slot.Width = width;
+	slot.Height = height;
+	slot.Frame = m_Frame;
+	slot.OnReady = onReady;
+	return true;
+}
+
+void AsyncReadback::Poll()
+{
+	// Oldest first, and stop at the first one still running so callbacks keep
+	// the order of the requests.
+	while (m_InFlight > 0 && Deliver(false))
+		;
+	m_Frame++;
+}
+
+void AsyncReadback::Flush()
+{
+	while (m_InFlight > 0)
+		Deliver(true);
+}
+
+bool AsyncReadback::Deliver(bool wait)
+{
+	Slot& slot = m_Slots[m_Oldest];
+	// The first wait flushes, otherwise a fence that never reached the GPU
+	// would be waited on forever.
+	GLuint64 timeout = wait ? 1000000000ull : 0;
+	GLCall(GLenum status = glClientWaitSync(slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout));
+	if (status == GL_TIMEOUT_EXPIRED)
+		return false;
+
+	GLCall(glDeleteSync(slot.Fence));
+	slot.Fence = nullptr;
+	m_Oldest = (m_Oldest + 1) % m_Slots.size();
+	m_InFlight--;
+	if (status == GL_WAIT_FAILED)
+	{
+		m_Dropped++;
+		slot.OnReady = nullptr;
+		return true;
+	}
+
+	unsigned int size = slot.Width * slot.Height * 4;
+	GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer));
+	GLCall(const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+	if (pixels)
+	{
+		ReadbackFrame frame = { (const unsigned char*)pixels, slot.Width, slot.Height, slot.Frame };
+		slot.OnReady(frame);
+		GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+	}
+	GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+	slot.OnReady = nullptr;
+	return true;
+}
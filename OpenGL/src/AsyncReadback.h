@@ -0,0 +1,64 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <GL/glew.h>
+
+class Framebuffer;
+
+// RGBA8 pixels, rows bottom to top like glReadPixels returns them. Only valid
+// during the callback.
+struct ReadbackFrame
+{
+	const unsigned char* Pixels;
+	int Width, Height;
+	unsigned long long Frame; // Value of the frame counter when it was requested
+};
+
+// Reads pixels back without stalling: Request() starts a glReadPixels into a
+// pixel pack buffer and drops a fence behind it, Poll() hands the pixels to
+// the callback once the fence has passed, typically two or three frames
+// later. When every buffer of the ring is still in flight the request is
+// dropped and counted instead of waiting.
+class AsyncReadback
+{
+public:
+	typedef std::function<void(const ReadbackFrame&)> Callback;
+private:
+	struct Slot
+	{
+		unsigned int Buffer;
+		unsigned int Size;
+		GLsync Fence; // nullptr while the slot is free
+		int Width, Height;
+		unsigned long long Frame;
+		Callback OnReady;
+	};
+
+	std::vector<Slot> m_Slots;
+	unsigned int m_Next;   // Next slot to fill; requests complete in this order
+	unsigned int m_Oldest; // Next slot to deliver
+	unsigned int m_InFlight;
+	unsigned long long m_Frame;
+	unsigned int m_Dropped;
+public:
+	AsyncReadback(unsigned int ringSize = 3);
+	~AsyncReadback(); // Pending callbacks are not called
+
+	// Reads a rectangle of the framebuffer's first color attachment, or of the
+	// window's back buffer with nullptr. Multisampled framebuffers have to be
+	// resolved first. False when the request was dropped or the rectangle is
+	// empty; only drops are counted.
+	bool Request(const Framebuffer* source, int x, int y, int width, int height, Callback onReady);
+
+	// Call once per frame: delivers finished reads and advances the frame counter.
+	void Poll();
+	// Blocks until every request is delivered, for shutdown or tests.
+	void Flush();
+
+	inline unsigned int GetPendingCount() const { return m_InFlight; }
+	inline unsigned int GetDroppedCount() const { return m_Dropped; }
+private:
+	bool Deliver(bool wait);
+};
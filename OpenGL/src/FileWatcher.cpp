@@ -0,0 +1,122 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#ifdef __linux__
+static std::string DirectoryOf(const std::string& filepath)
+{
+	size_t slash = filepath.find_last_of("/\\");
+	return slash == std::string::npos ? "." : filepath.substr(0, slash);
+}
+
+static std::string FileNameOf(const std::string& filepath)
+{
+	size_t slash = filepath.find_last_of("/\\");
+	return slash == std::string::npos ? filepath : filepath.substr(slash + 1);
+}
+#else
+static long long GetModifiedTime(const std::string& filepath)
+{
+	struct stat info;
+	if (stat(filepath.c_str(), &info) != 0)
+		return -1;
+	return (long long)info.st_mtime;
+}
+#endif
+
+FileWatcher::FileWatcher()
+{
+#ifdef __linux__
+	m_Notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_Notify < 0)
+		std::cout << "Warning: inotify unavailable, shader hot reload disabled" << std::endl;
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+	if (m_Notify >= 0)
+		close(m_Notify);
+#endif
+}
+
+void FileWatcher::Watch(const std::string& filepath)
+{
+	if (std::find(m_Files.begin(), m_Files.end(), filepath) != m_Files.end())
+		return;
+	m_Files.push_back(filepath);
+
+#ifdef __linux__
+	if (m_Notify < 0)
+		return;
+
+	// Watch the directory, not the file: most editors save by writing a new file
+	// and renaming it over the old one, which would drop a per-file watch.
+	std::string directory = DirectoryOf(filepath);
+	for (const auto& entry : m_Directories)
+		if (entry.second == directory)
+			return;
+
+	int wd = inotify_add_watch(m_Notify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (wd < 0)
+		std::cout << "Warning: can't watch '" << directory << "'" << std::endl;
+	else
+		m_Directories[wd] = directory;
+#else
+	m_ModifiedTimes[filepath] = GetModifiedTime(filepath);
+#endif
+}
+
+void FileWatcher::Poll(std::vector<std::string>& changed)
+{
+#ifdef __linux__
+	if (m_Notify < 0)
+		return;
+
+	alignas(struct inotify_event) char buffer[4096];
+	for (;;)
+	{
+		ssize_t length = read(m_Notify, buffer, sizeof(buffer));
+		if (length <= 0)
+			break; // EAGAIN: nothing left to read.
+
+		for (char* ptr = buffer; ptr < buffer + length;)
+		{
+			const struct inotify_event* event = (const struct inotify_event*)ptr;
+			ptr += sizeof(struct inotify_event) + event->len;
+
+			auto directory = m_Directories.find(event->wd);
+			if (event->len == 0 || directory == m_Directories.end())
+				continue;
+
+			for (const std::string& file : m_Files)
+			{
+				if (DirectoryOf(file) == directory->second && FileNameOf(file) == event->name
+					&& std::find(changed.begin(), changed.end(), file) == changed.end())
+					changed.push_back(file);
+			}
+		}
+	}
+#else
+	for (auto& entry : m_ModifiedTimes)
+	{
+		long long modified = GetModifiedTime(entry.first);
+		if (modified != -1 && modified != entry.second)
+		{
+			entry.second = modified;
+			changed.push_back(entry.first);
+		}
+	}
+#endif
+}
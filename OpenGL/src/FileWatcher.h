@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reports files that were written since the last Poll(). Uses inotify on Linux
+// and falls back to comparing modification times everywhere else.
+// Poll() never blocks, so it is safe to call once per frame.
+class FileWatcher
+{
+private:
+#ifdef __linux__
+	int m_Notify;
+	std::unordered_map<int, std::string> m_Directories; // watch descriptor -> directory
+#else
+	std::unordered_map<std::string, long long> m_ModifiedTimes;
+#endif
+	std::vector<std::string> m_Files;
+public:
+	FileWatcher();
+	~FileWatcher();
+
+	void Watch(const std::string& filepath);
+	void Poll(std::vector<std::string>& changed);
+};
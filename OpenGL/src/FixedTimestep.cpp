@@ -0,0 +1,39 @@
+#include "FixedTimestep.h"
+
+FixedTimestep::FixedTimestep(double step, unsigned int maxStepsPerFrame)
+	: m_Step(step), m_MaxSteps(maxStepsPerFrame), m_LastTime(-1.0), m_Accumulator(0.0), m_TotalSteps(0), m_DroppedTime(0.0)
+{
+}
+
+unsigned int FixedTimestep::Advance(double now)
+{
+	if (m_LastTime < 0.0)
+	{
+		m_LastTime = now;
+		return 0;
+	}
+
+	double elapsed = now - m_LastTime;
+	m_LastTime = now;
+	if (elapsed > 0.0)
+		m_Accumulator += elapsed;
+
+	unsigned int steps = 0;
+	while (m_Accumulator >= m_Step && steps < m_MaxSteps)
+	{
+		m_Accumulator -= m_Step;
+		steps++;
+	}
+
+	// Still more than a step behind: drop whole steps, keep the fraction so
+	// interpolation doesn't jump.
+	if (m_Accumulator >= m_Step)
+	{
+		double dropped = m_Step * (unsigned long long)(m_Accumulator / m_Step);
+		m_DroppedTime += dropped;
+		m_Accumulator -= dropped;
+	}
+
+	m_TotalSteps += steps;
+	return steps;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Decouples simulation from the frame rate: the simulation always advances in
+// steps of the same length, as many per rendered frame as the elapsed time
+// calls for, and rendering blends the last two states with GetAlpha(). The
+// results are the same whether the loop runs at 30 Hz, 144 Hz or uncapped.
+//
+//	for (unsigned int steps = timestep.Advance(glfwGetTime()); steps > 0; steps--)
+//		{ previous = current; Simulate(current, timestep.GetStep()); }
+//	Render(Lerp(previous, current, timestep.GetAlpha()));
+class FixedTimestep
+{
+private:
+	double m_Step;
+	unsigned int m_MaxSteps;
+	double m_LastTime; // < 0 before the first Advance
+	double m_Accumulator;
+	unsigned long long m_TotalSteps;
+	double m_DroppedTime;
+public:
+	// After a hitch (breakpoint, window drag, load) at most maxStepsPerFrame
+	// steps run in one frame; the rest of the backlog is dropped instead of
+	// making every following frame slower as well.
+	FixedTimestep(double step = 1.0 / 60.0, unsigned int maxStepsPerFrame = 5);
+
+	// Number of steps to simulate this frame. now is in seconds, from any
+	// monotonic clock; the first call only starts the clock.
+	unsigned int Advance(double now);
+
+	// How far between the previous and the current simulation state the
+	// render time lies, 0 to 1.
+	inline float GetAlpha() const { return (float)(m_Accumulator / m_Step); }
+	inline double GetStep() const { return m_Step; }
+	inline unsigned long long GetTotalSteps() const { return m_TotalSteps; }
+	// Simulation time given up by the catch-up limit, in seconds.
+	inline double GetDroppedTime() const { return m_DroppedTime; }
+};
@@ -0,0 +1,158 @@
+#include "FrameCapture.h"
+
+#include <cstdio>
+#include <iostream>
+
+#include "ImageWriter.h"
+
+FrameCapture::FrameCapture(const std::string& path, CaptureFormat format, unsigned int queueSize,
+	CaptureDropPolicy dropPolicy, unsigned int threads, int frameRate)
+	: m_Path(path), m_Format(format), m_DropPolicy(dropPolicy), m_QueueSize(queueSize > 0 ? queueSize : 1),
+	  m_FrameRate(frameRate), m_NextIndex(0), m_Stats{ 0, 0, 0 }, m_Quit(false), m_StreamWidth(0), m_StreamHeight(0), m_SizeWarned(false)
+{
+	if (format != CaptureFormat::PNG)
+	{
+		m_Stream.open(path, std::ios::binary);
+		if (!m_Stream)
+			std::cout << "Failed to open '" << path << "' for capture" << std::endl;
+		threads = 1; // Frames have to land in the file in order.
+	}
+	else if (threads == 0)
+	{
+		threads = std::thread::hardware_concurrency();
+		threads = threads > 1 ? threads - 1 : 1; // Leave the render thread its core.
+	}
+
+	for (unsigned int i = 0; i < threads; i++)
+		m_Workers.emplace_back(&FrameCapture::WorkerLoop, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+	m_Readback.Flush();
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Quit = true;
+	}
+	m_Condition.notify_all();
+	for (std::thread& worker : m_Workers)
+		worker.join();
+}
+
+void FrameCapture::Capture(const Framebuffer* source, int width, int height)
+{
+	if (width <= 0 || height <= 0)
+	{
+		m_Readback.Poll();
+		return;
+	}
+
+	unsigned int readbackDropped = m_Readback.GetDroppedCount();
+	m_Readback.Request(source, 0, 0, width, height, [this](const ReadbackFrame& frame) { Enqueue(frame); });
+	m_Readback.Poll();
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stats.Requested++;
+	m_Stats.Dropped += m_Readback.GetDroppedCount() - readbackDropped;
+}
+
+void FrameCapture::Enqueue(const ReadbackFrame& readback)
+{
+	unsigned long long index = m_NextIndex++;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_Queue.size() >= m_QueueSize)
+		{
+			m_Stats.Dropped++;
+			if (m_DropPolicy == CaptureDropPolicy::DropNewest)
+				return;
+			m_Queue.pop_front();
+		}
+
+		// Copied under the lock so a dropped frame costs no copy; the mapped
+		// buffer is only valid during the callback.
+		m_Queue.emplace_back();
+		Frame& frame = m_Queue.back();
+		frame.Pixels.assign(readback.Pixels, readback.Pixels + (size_t)readback.Width * readback.Height * 4);
+		frame.Width = readback.Width;
+		frame.Height = readback.Height;
+		frame.Index = index;
+	}
+	m_Condition.notify_one();
+}
+
+void FrameCapture::WorkerLoop()
+{
+	for (;;)
+	{
+		Frame frame;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this] { return m_Quit || !m_Queue.empty(); });
+			// Drain the queue before quitting, the point is to keep the frames.
+			if (m_Queue.empty())
+				return;
+			frame = std::move(m_Queue.front());
+			m_Queue.pop_front();
+		}
+
+		Write(frame);
+	}
+}
+
+void FrameCapture::Write(const Frame& frame)
+{
+	bool written = false;
+	if (m_Format == CaptureFormat::PNG)
+	{
+		char suffix[32];
+		snprintf(suffix, sizeof(suffix), "_%06llu.png", frame.Index);
+		written = ImageWriter::WritePNG(m_Path + suffix, frame.Pixels.data(), frame.Width, frame.Height, 4, true);
+	}
+	else if (m_Stream)
+	{
+		if (m_StreamWidth == 0)
+		{
+			m_StreamWidth = frame.Width;
+			m_StreamHeight = frame.Height;
+			if (m_Format == CaptureFormat::Y4M)
+				m_Stream << "YUV4MPEG2 W" << frame.Width << " H" << frame.Height << " F" << m_FrameRate << ":1 Ip A1:1 C420jpeg\n";
+		}
+
+		if (frame.Width == m_StreamWidth && frame.Height == m_StreamHeight)
+		{
+			if (m_Format == CaptureFormat::Y4M)
+			{
+				std::vector<unsigned char> yuv;
+				ImageWriter::ConvertToYUV420(frame.Pixels.data(), frame.Width, frame.Height, true, yuv);
+				m_Stream << "FRAME\n";
+				m_Stream.write((const char*)yuv.data(), yuv.size());
+			}
+			else
+			{
+				size_t stride = (size_t)frame.Width * 4;
+				for (int y = frame.Height - 1; y >= 0; y--)
+					m_Stream.write((const char*)&frame.Pixels[stride * y], stride);
+			}
+			written = (bool)m_Stream;
+		}
+		else if (!m_SizeWarned)
+		{
+			m_SizeWarned = true;
+			std::cout << "Warning: capture '" << m_Path << "' is " << m_StreamWidth << "x" << m_StreamHeight
+				<< ", frames of another size are dropped" << std::endl;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (written)
+		m_Stats.Written++;
+	else
+		m_Stats.Dropped++;
+}
+
+FrameCaptureStats FrameCapture::GetStats()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Stats;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AsyncReadback.h"
+
+class Framebuffer;
+
+enum class CaptureFormat
+{
+	Y4M, // One .y4m file, 4:2:0, plays in ffplay/mpv
+	Raw, // One file of RGBA8 frames back to back, rows top to bottom
+	PNG  // <path>_000042.png per frame, encoded on every core
+};
+
+enum class CaptureDropPolicy
+{
+	DropNewest, // Keep what is queued, lose the frame that doesn't fit
+	DropOldest  // Make room by losing the oldest queued frame
+};
+
+struct FrameCaptureStats
+{
+	unsigned int Requested; // Capture() calls
+	unsigned int Written;
+	unsigned int Dropped;   // Readback ring or queue full, or the size changed mid-stream
+};
+
+// Records frames to disk without holding up rendering: frames come back
+// through AsyncReadback, wait in a bounded queue and are encoded and written
+// on background threads. When the writers fall behind, frames are dropped
+// (and counted) rather than slowing the render loop down.
+class FrameCapture
+{
+private:
+	struct Frame
+	{
+		std::vector<unsigned char> Pixels; // RGBA8, bottom to top
+		int Width, Height;
+		unsigned long long Index;
+	};
+
+	std::string m_Path;
+	CaptureFormat m_Format;
+	CaptureDropPolicy m_DropPolicy;
+	unsigned int m_QueueSize;
+	int m_FrameRate;
+	AsyncReadback m_Readback;
+	unsigned long long m_NextIndex;
+
+	std::vector<std::thread> m_Workers;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::deque<Frame> m_Queue;
+	FrameCaptureStats m_Stats;
+	bool m_Quit;
+
+	// Y4M and Raw: only touched by the single writer thread.
+	std::ofstream m_Stream;
+	int m_StreamWidth, m_StreamHeight;
+	bool m_SizeWarned;
+public:
+	// threads = 0 uses every core for PNG; Y4M and Raw are written in order by
+	// one thread. frameRate only goes into the Y4M header.
+	FrameCapture(const std::string& path, CaptureFormat format, unsigned int queueSize = 8,
+		CaptureDropPolicy dropPolicy = CaptureDropPolicy::DropOldest, unsigned int threads = 0, int frameRate = 60);
+	// Writes out everything still queued or in flight.
+	~FrameCapture();
+
+	// Call once per frame after drawing: grabs the framebuffer's first color
+	// attachment, or the window's back buffer with nullptr.
+	void Capture(const Framebuffer* source, int width, int height);
+
+	FrameCaptureStats GetStats();
+private:
+	void Enqueue(const ReadbackFrame& frame);
+	void WorkerLoop();
+	void Write(const Frame& frame);
+};
@@ -0,0 +1,112 @@
+#include "FramePacer.h"
+
+#include <thread>
+
+#include <GLFW/glfw3.h>
+
+static void OnInput(GLFWwindow* window)
+{
+	FramePacer* pacer = (FramePacer*)glfwGetWindowUserPointer(window);
+	if (pacer)
+		pacer->RequestRedraw();
+}
+
+FramePacer::FramePacer(GLFWwindow* window, PresentMode mode)
+	: m_Window(window), m_PresentMode(mode), m_FrameLimit(0.0), m_RenderOnDemand(false), m_RedrawRequested(true),
+	  m_IdleTimeout(0.1), m_NextFrame(Clock::now()), m_SleepOvershoot(std::chrono::milliseconds(1)), m_SkippedFrames(0)
+{
+	SetPresentMode(mode);
+
+	glfwSetWindowUserPointer(window, this);
+	glfwSetWindowRefreshCallback(window, [](GLFWwindow* w) { OnInput(w); });
+	glfwSetFramebufferSizeCallback(window, [](GLFWwindow* w, int, int) { OnInput(w); });
+	glfwSetWindowFocusCallback(window, [](GLFWwindow* w, int) { OnInput(w); });
+	glfwSetKeyCallback(window, [](GLFWwindow* w, int, int, int, int) { OnInput(w); });
+	glfwSetMouseButtonCallback(window, [](GLFWwindow* w, int, int, int) { OnInput(w); });
+	glfwSetCursorPosCallback(window, [](GLFWwindow* w, double, double) { OnInput(w); });
+	glfwSetScrollCallback(window, [](GLFWwindow* w, double, double) { OnInput(w); });
+}
+
+void FramePacer::SetPresentMode(PresentMode mode)
+{
+	if (mode == PresentMode::Adaptive && !glfwExtensionSupported("WGL_EXT_swap_control_tear")
+		&& !glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+		mode = PresentMode::VSync;
+
+	m_PresentMode = mode;
+	// A negative interval is how both extensions spell "adaptive".
+	glfwSwapInterval(mode == PresentMode::VSync ? 1 : mode == PresentMode::Adaptive ? -1 : 0);
+}
+
+void FramePacer::SetFrameLimit(double framesPerSecond)
+{
+	m_FrameLimit = framesPerSecond;
+	m_NextFrame = Clock::now();
+}
+
+void FramePacer::SetRenderOnDemand(bool enabled, double idleTimeout)
+{
+	m_RenderOnDemand = enabled;
+	m_IdleTimeout = idleTimeout;
+	m_RedrawRequested = true;
+}
+
+void FramePacer::RequestRedraw()
+{
+	m_RedrawRequested = true;
+}
+
+bool FramePacer::ShouldRender()
+{
+	if (!m_RenderOnDemand || m_RedrawRequested)
+	{
+		m_RedrawRequested = false;
+		return true;
+	}
+	m_SkippedFrames++;
+	return false;
+}
+
+void FramePacer::EndFrame()
+{
+	Limit();
+
+	if (m_RenderOnDemand && !m_RedrawRequested)
+		glfwWaitEventsTimeout(m_IdleTimeout);
+	else
+		glfwPollEvents();
+}
+
+void FramePacer::Limit()
+{
+	if (m_FrameLimit <= 0.0)
+		return;
+
+	Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_FrameLimit));
+	m_NextFrame += period;
+
+	Clock::time_point now = Clock::now();
+	// More than a frame behind (a hitch, or the limit is above what we can
+	// do): start over from now instead of racing to catch up.
+	if (now > m_NextFrame + period)
+	{
+		m_NextFrame = now;
+		return;
+	}
+
+	// Sleep while there's comfortably more time left than sleep tends to
+	// oversleep, then spin for the last stretch.
+	if (m_NextFrame - now > m_SleepOvershoot)
+	{
+		Clock::duration sleep = m_NextFrame - now - m_SleepOvershoot;
+		std::this_thread::sleep_for(sleep);
+		Clock::duration overshoot = Clock::now() - now - sleep;
+		// Follow increases at once, decreases slowly.
+		if (overshoot > m_SleepOvershoot)
+			m_SleepOvershoot = overshoot;
+		else
+			m_SleepOvershoot -= (m_SleepOvershoot - overshoot) / 16;
+	}
+	while (Clock::now() < m_NextFrame)
+		std::this_thread::yield();
+}
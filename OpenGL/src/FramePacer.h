@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+
+struct GLFWwindow;
+
+enum class PresentMode
+{
+	VSync,    // Wait for vertical blank
+	Adaptive, // VSync, but tear instead of halving the rate when a frame is late
+	Off       // Present immediately; pair with a frame limit to save power
+};
+
+// Decides when the next frame starts: swap interval, an optional frame rate
+// cap, and render-on-demand, where frames are only drawn after something
+// called RequestRedraw (input does so on its own) and the thread sleeps in
+// glfwWaitEvents the rest of the time.
+//
+//	if (pacer.ShouldRender()) { draw; glfwSwapBuffers(window); }
+//	pacer.EndFrame(); // replaces glfwPollEvents
+class FramePacer
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	GLFWwindow* m_Window;
+	PresentMode m_PresentMode;
+	double m_FrameLimit;
+	bool m_RenderOnDemand;
+	bool m_RedrawRequested;
+	double m_IdleTimeout;
+	Clock::time_point m_NextFrame;
+	Clock::duration m_SleepOvershoot; // Learned: how late sleep_for tends to wake up
+	unsigned long long m_SkippedFrames;
+public:
+	// Installs input callbacks and uses the window's user pointer.
+	FramePacer(GLFWwindow* window, PresentMode mode = PresentMode::VSync);
+
+	// Adaptive falls back to VSync without (WGL|GLX)_EXT_swap_control_tear.
+	void SetPresentMode(PresentMode mode);
+	inline PresentMode GetPresentMode() const { return m_PresentMode; }
+
+	// Frames per second, 0 for no cap. Sleeps until just before the deadline
+	// and spins the rest, so it holds the rate far more precisely than a
+	// sleep alone on systems with a coarse timer.
+	void SetFrameLimit(double framesPerSecond);
+
+	// While idle, events are still checked every idleTimeout seconds so
+	// polling work (hot reload, streaming) keeps going.
+	void SetRenderOnDemand(bool enabled, double idleTimeout = 0.1);
+	inline bool IsRenderOnDemand() const { return m_RenderOnDemand; }
+
+	void RequestRedraw();
+	// Always true unless render-on-demand is on and nothing asked for a frame.
+	bool ShouldRender();
+	// Call at the end of every loop iteration, rendered or not.
+	void EndFrame();
+
+	inline unsigned long long GetSkippedFrames() const { return m_SkippedFrames; }
+private:
+	void Limit();
+};
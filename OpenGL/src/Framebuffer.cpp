@@ -0,0 +1,234 @@
+#include "Framebuffer.h"
+
+#include <iostream>
+
+#include "Renderer.h"
+
+Framebuffer::Framebuffer(const FramebufferSpec& spec)
+	: m_RendererID(0), m_Spec(spec), m_DepthStencilAttachment(0)
+{
+	Create();
+}
+
+Framebuffer::~Framebuffer()
+{
+	Destroy();
+}
+
+void Framebuffer::Create()
+{
+	GLCall(glGenFramebuffers(1, &m_RendererID));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+
+	std::vector<unsigned int> drawBuffers;
+	for (unsigned int i = 0; i < m_Spec.Colors.size(); i++)
+	{
+		m_ColorAttachments.push_back(CreateAttachment(m_Spec.Colors[i], GL_COLOR_ATTACHMENT0 + i));
+		drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+	}
+	if (m_Spec.DepthStencil.Format != 0)
+		m_DepthStencilAttachment = CreateAttachment(m_Spec.DepthStencil, GetDepthStencilAttachmentPoint());
+
+	if (drawBuffers.empty())
+	{
+		GLCall(glDrawBuffer(GL_NONE));
+		GLCall(glReadBuffer(GL_NONE));
+	}
+	else
+	{
+		GLCall(glDrawBuffers((int)drawBuffers.size(), drawBuffers.data()));
+	}
+
+	GLCall(unsigned int status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "Warning: framebuffer " << m_Spec.Width << "x" << m_Spec.Height << " is incomplete (" << status << ")" << std::endl;
+
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+unsigned int Framebuffer::CreateAttachment(const FramebufferAttachment& attachment, unsigned int attachmentPoint)
+{
+	unsigned int id;
+	if (attachment.Sampled)
+	{
+		GLCall(glGenTextures(1, &id));
+		if (m_Spec.Samples > 1)
+		{
+			GLCall(glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, id));
+			GLCall(glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, m_Spec.Samples, attachment.Format, m_Spec.Width, m_Spec.Height, GL_TRUE));
+			GLCall(glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0));
+			GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, attachmentPoint, GL_TEXTURE_2D_MULTISAMPLE, id, 0));
+		}
+		else
+		{
+			// One level, no mips: render targets are read at full size.
+			GLCall(glBindTexture(GL_TEXTURE_2D, id));
+			if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage)
+			{
+				GLCall(glTexStorage2D(GL_TEXTURE_2D, 1, attachment.Format, m_Spec.Width, m_Spec.Height));
+			}
+			else
+			{
+				// The format and type only describe the (absent) client data,
+				// but have to be compatible with the internal format.
+				bool depth = attachmentPoint == GL_DEPTH_ATTACHMENT || attachmentPoint == GL_DEPTH_STENCIL_ATTACHMENT;
+				unsigned int format = attachmentPoint == GL_DEPTH_STENCIL_ATTACHMENT ? GL_DEPTH_STENCIL : depth ? GL_DEPTH_COMPONENT : GL_RGBA;
+				unsigned int type = attachmentPoint == GL_DEPTH_STENCIL_ATTACHMENT ? GL_UNSIGNED_INT_24_8 : GL_UNSIGNED_BYTE;
+				GLCall(glTexImage2D(GL_TEXTURE_2D, 0, attachment.Format, m_Spec.Width, m_Spec.Height, 0, format, type, nullptr));
+				GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+			}
+			GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+			GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, attachmentPoint, GL_TEXTURE_2D, id, 0));
+		}
+	}
+	else
+	{
+		GLCall(glGenRenderbuffers(1, &id));
+		GLCall(glBindRenderbuffer(GL_RENDERBUFFER, id));
+		if (m_Spec.Samples > 1)
+		{
+			GLCall(glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_Spec.Samples, attachment.Format, m_Spec.Width, m_Spec.Height));
+		}
+		else
+		{
+			GLCall(glRenderbufferStorage(GL_RENDERBUFFER, attachment.Format, m_Spec.Width, m_Spec.Height));
+		}
+		GLCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+		GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachmentPoint, GL_RENDERBUFFER, id));
+	}
+	return id;
+}
+
+void Framebuffer::Destroy()
+{
+	for (unsigned int i = 0; i < m_ColorAttachments.size(); i++)
+	{
+		if (m_Spec.Colors[i].Sampled)
+		{
+			GLCall(glDeleteTextures(1, &m_ColorAttachments[i]));
+		}
+		else
+		{
+			GLCall(glDeleteRenderbuffers(1, &m_ColorAttachments[i]));
+		}
+	}
+	m_ColorAttachments.clear();
+
+	if (m_DepthStencilAttachment != 0)
+	{
+		if (m_Spec.DepthStencil.Sampled)
+		{
+			GLCall(glDeleteTextures(1, &m_DepthStencilAttachment));
+		}
+		else
+		{
+			GLCall(glDeleteRenderbuffers(1, &m_DepthStencilAttachment));
+		}
+		m_DepthStencilAttachment = 0;
+	}
+
+	GLCall(glDeleteFramebuffers(1, &m_RendererID));
+	m_RendererID = 0;
+}
+
+void Framebuffer::Resize(int width, int height)
+{
+	if (width <= 0 || height <= 0 || (width == m_Spec.Width && height == m_Spec.Height))
+		return;
+
+	Destroy();
+	m_Spec.Width = width;
+	m_Spec.Height = height;
+	Create();
+}
+
+unsigned int Framebuffer::GetDepthStencilAttachmentPoint() const
+{
+	switch (m_Spec.DepthStencil.Format)
+	{
+		case GL_DEPTH24_STENCIL8:
+		case GL_DEPTH32F_STENCIL8:
+			return GL_DEPTH_STENCIL_ATTACHMENT;
+		case GL_STENCIL_INDEX8:
+			return GL_STENCIL_ATTACHMENT;
+	}
+	return GL_DEPTH_ATTACHMENT;
+}
+
+unsigned int Framebuffer::GetClearMask() const
+{
+	unsigned int mask = m_Spec.Colors.empty() ? 0 : GL_COLOR_BUFFER_BIT;
+	if (m_Spec.DepthStencil.Format != 0)
+	{
+		unsigned int point = GetDepthStencilAttachmentPoint();
+		if (point != GL_STENCIL_ATTACHMENT)
+			mask |= GL_DEPTH_BUFFER_BIT;
+		if (point != GL_DEPTH_ATTACHMENT)
+			mask |= GL_STENCIL_BUFFER_BIT;
+	}
+	return mask;
+}
+
+void Framebuffer::Bind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+}
+
+void Framebuffer::Unbind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::Resolve(const Framebuffer* target, unsigned int mask, unsigned int colorAttachment) const
+{
+	int width = target ? target->GetWidth() : m_Spec.Width;
+	int height = target ? target->GetHeight() : m_Spec.Height;
+
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+	GLCall(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target ? target->GetRendererID() : 0));
+	if (mask & GL_COLOR_BUFFER_BIT)
+	{
+		GLCall(glReadBuffer(GL_COLOR_ATTACHMENT0 + colorAttachment));
+	}
+	// Multisampled sources can't be scaled, and depth/stencil never filter.
+	bool sameSize = width == m_Spec.Width && height == m_Spec.Height;
+	unsigned int filter = sameSize || (mask & ~GL_COLOR_BUFFER_BIT) ? GL_NEAREST : GL_LINEAR;
+	GLCall(glBlitFramebuffer(0, 0, m_Spec.Width, m_Spec.Height, 0, 0, width, height, mask, filter));
+
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::Invalidate() const
+{
+	if (!GLEW_VERSION_4_3 && !GLEW_ARB_invalidate_subdata)
+		return;
+
+	std::vector<unsigned int> attachments;
+	for (unsigned int i = 0; i < m_Spec.Colors.size(); i++)
+	{
+		if (!m_Spec.Colors[i].Keep)
+			attachments.push_back(GL_COLOR_ATTACHMENT0 + i);
+	}
+	if (m_Spec.DepthStencil.Format != 0 && !m_Spec.DepthStencil.Keep)
+		attachments.push_back(GetDepthStencilAttachmentPoint());
+	if (attachments.empty())
+		return;
+
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glInvalidateFramebuffer(GL_FRAMEBUFFER, (int)attachments.size(), attachments.data()));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::BindColorTexture(unsigned int index, unsigned int slot) const
+{
+	ASSERT(m_Spec.Colors[index].Sampled);
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(m_Spec.Samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, m_ColorAttachments[index]));
+}
+
+void Framebuffer::BindDepthTexture(unsigned int slot) const
+{
+	ASSERT(m_Spec.DepthStencil.Sampled);
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(m_Spec.Samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, m_DepthStencilAttachment));
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+struct FramebufferAttachment
+{
+	unsigned int Format; // GL internal format, 0 for none
+	bool Sampled;        // Texture to read in a shader later, otherwise a renderbuffer
+	bool Keep;           // False: contents are dropped by Invalidate() once the frame is done
+
+	FramebufferAttachment(unsigned int format = 0, bool sampled = false, bool keep = true)
+		: Format(format), Sampled(sampled), Keep(keep) {}
+};
+
+struct FramebufferSpec
+{
+	int Width, Height;
+	int Samples; // 1 for none; multisampled attachments are read through Resolve
+	std::vector<FramebufferAttachment> Colors;
+	// GL_DEPTH24_STENCIL8, GL_DEPTH_COMPONENT24, GL_STENCIL_INDEX8, ...
+	FramebufferAttachment DepthStencil;
+};
+
+// Offscreen render target. Point a Renderer at it with Renderer::SetTarget.
+class Framebuffer
+{
+private:
+	unsigned int m_RendererID;
+	FramebufferSpec m_Spec;
+	std::vector<unsigned int> m_ColorAttachments; // texture or renderbuffer names
+	unsigned int m_DepthStencilAttachment;
+public:
+	Framebuffer(const FramebufferSpec& spec);
+	~Framebuffer();
+
+	void Bind() const;
+	void Unbind() const;
+
+	// Reallocates every attachment; the contents are lost.
+	void Resize(int width, int height);
+
+	// Copies into target (nullptr for the window) with glBlitFramebuffer, which
+	// also resolves multisampled color. mask takes GL_COLOR_BUFFER_BIT,
+	// GL_DEPTH_BUFFER_BIT and GL_STENCIL_BUFFER_BIT; depth and stencil need
+	// matching formats on both sides.
+	void Resolve(const Framebuffer* target, unsigned int mask = GL_COLOR_BUFFER_BIT, unsigned int colorAttachment = 0) const;
+	// Tells the driver the attachments created with Keep = false don't have to
+	// be stored; tiled GPUs then skip writing them back to memory. Needs GL 4.3
+	// or ARB_invalidate_subdata, otherwise it does nothing.
+	void Invalidate() const;
+
+	// Only for attachments created with Sampled = true.
+	void BindColorTexture(unsigned int index = 0, unsigned int slot = 0) const;
+	void BindDepthTexture(unsigned int slot = 0) const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline const FramebufferSpec& GetSpec() const { return m_Spec; }
+	inline int GetWidth() const { return m_Spec.Width; }
+	inline int GetHeight() const { return m_Spec.Height; }
+	inline unsigned int GetColorAttachment(unsigned int index = 0) const { return m_ColorAttachments[index]; }
+	inline unsigned int GetDepthStencilAttachment() const { return m_DepthStencilAttachment; }
+	// GL_*_BUFFER_BIT of every attachment, what Renderer::Clear clears.
+	unsigned int GetClearMask() const;
+private:
+	void Create();
+	void Destroy();
+	unsigned int CreateAttachment(const FramebufferAttachment& attachment, unsigned int attachmentPoint);
+	unsigned int GetDepthStencilAttachmentPoint() const;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+// 64-bit FNV-1a, for cache keys and content dedup. Not for anything adversarial.
+static const unsigned long long HASH_SEED = 14695981039346656037ull;
+
+inline unsigned long long HashBytes(const void* data, size_t size, unsigned long long hash = HASH_SEED)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// Includes the terminator so ("ab", "c") and ("a", "bc") differ.
+inline unsigned long long HashString(const char* str, unsigned long long hash = HASH_SEED)
+{
+	return str ? HashBytes(str, strlen(str) + 1, hash) : hash;
+}
@@ -0,0 +1,161 @@
+#include "ImageArena.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+	// Keeps every block 16-byte aligned, which stb_image's SSE2 code expects.
+	const size_t HeaderSize = 16;
+	const size_t MinChunkSize = 1024 * 1024;
+
+	struct Chunk
+	{
+		char* Data;
+		size_t Size;
+		size_t Used;
+	};
+
+	struct Arena
+	{
+		std::vector<Chunk> Chunks;
+		char* Last;  // Newest block, the only one Free and in-place growth can touch
+		size_t Used; // Bytes handed out across all chunks
+		ImageArenaStats Stats;
+
+		Arena() : Last(nullptr), Used(0), Stats{ 0, 0, 0 } {}
+		~Arena()
+		{
+			for (const Chunk& chunk : Chunks)
+				free(chunk.Data);
+		}
+	};
+
+	thread_local Arena s_Arena;
+
+	inline size_t RoundUp(size_t size)
+	{
+		return (size + HeaderSize - 1) & ~(HeaderSize - 1);
+	}
+
+	inline size_t& BlockSize(void* block)
+	{
+		return *(size_t*)((char*)block - HeaderSize);
+	}
+
+	void AddUsed(Arena& arena, size_t bytes)
+	{
+		arena.Used += bytes;
+		if (arena.Used > arena.Stats.PeakBytes)
+			arena.Stats.PeakBytes = arena.Used;
+	}
+
+}
+
+void* ImageArena::Allocate(size_t size)
+{
+	Arena& arena = s_Arena;
+	size_t needed = HeaderSize + RoundUp(size);
+	if (arena.Chunks.empty() || arena.Chunks.back().Used + needed > arena.Chunks.back().Size)
+	{
+		size_t chunkSize = arena.Chunks.empty() ? MinChunkSize : arena.Chunks.back().Size * 2;
+		if (chunkSize < needed)
+			chunkSize = needed;
+		Chunk chunk = { (char*)malloc(chunkSize), chunkSize, 0 };
+		if (!chunk.Data)
+			return nullptr;
+		arena.Chunks.push_back(chunk);
+	}
+
+	Chunk& chunk = arena.Chunks.back();
+	char* block = chunk.Data + chunk.Used + HeaderSize;
+	chunk.Used += needed;
+	AddUsed(arena, needed);
+	arena.Stats.Allocations++;
+	arena.Last = block;
+	BlockSize(block) = size;
+	return block;
+}
+
+void* ImageArena::Reallocate(void* block, size_t size)
+{
+	if (!block)
+		return Allocate(size);
+
+	Arena& arena = s_Arena;
+	size_t oldSize = BlockSize(block);
+	// zlib output grows one doubling at a time, usually as the newest block.
+	if (block == arena.Last)
+	{
+		Chunk& chunk = arena.Chunks.back();
+		size_t oldRounded = RoundUp(oldSize), newRounded = RoundUp(size);
+		if (chunk.Used - oldRounded + newRounded <= chunk.Size)
+		{
+			chunk.Used = chunk.Used - oldRounded + newRounded;
+			arena.Used -= oldRounded;
+			AddUsed(arena, newRounded);
+			arena.Stats.Allocations++;
+			arena.Stats.GrownInPlace++;
+			BlockSize(block) = size;
+			return block;
+		}
+	}
+
+	void* moved = Allocate(size);
+	if (moved)
+		memcpy(moved, block, oldSize < size ? oldSize : size);
+	return moved;
+}
+
+void ImageArena::Free(void* block)
+{
+	Arena& arena = s_Arena;
+	if (!block || block != arena.Last)
+		return;
+
+	size_t bytes = HeaderSize + RoundUp(BlockSize(block));
+	arena.Chunks.back().Used -= bytes;
+	arena.Used -= bytes;
+	arena.Last = nullptr;
+}
+
+ImageArenaStats ImageArena::Reset()
+{
+	Arena& arena = s_Arena;
+	ImageArenaStats stats = arena.Stats;
+
+	// A decode that needed several chunks gets one chunk of the total size, so
+	// the next image of that size fits without growing again.
+	if (arena.Chunks.size() > 1)
+	{
+		size_t total = 0;
+		for (const Chunk& chunk : arena.Chunks)
+		{
+			total += chunk.Size;
+			free(chunk.Data);
+		}
+		arena.Chunks.clear();
+		Chunk chunk = { (char*)malloc(total), total, 0 };
+		if (chunk.Data)
+			arena.Chunks.push_back(chunk);
+	}
+	else if (!arena.Chunks.empty())
+	{
+		arena.Chunks.back().Used = 0;
+	}
+
+	arena.Last = nullptr;
+	arena.Used = 0;
+	arena.Stats = { 0, 0, 0 };
+	return stats;
+}
+
+void ImageArena::Release()
+{
+	Reset();
+	Arena& arena = s_Arena;
+	for (const Chunk& chunk : arena.Chunks)
+		free(chunk.Data);
+	arena.Chunks.clear();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+struct ImageArenaStats
+{
+	unsigned int Allocations;   // malloc and realloc calls made by the decoder
+	unsigned int GrownInPlace;  // reallocs that didn't have to move
+	size_t PeakBytes;
+};
+
+// Per-thread bump allocator behind STBI_MALLOC/STBI_REALLOC/STBI_FREE (see
+// vendor/stb_image/stb_image.cpp). A decode makes many short-lived
+// allocations; here they cost a pointer bump, and the memory is reused by the
+// next decode on the same thread instead of going back to the heap.
+//
+// Frees only give memory back when they release the newest block, so the
+// caller must Reset() once the decoded pixels are no longer needed, before
+// the next stbi_load on that thread. Anything stb_image returned on this
+// thread is invalid after Reset().
+class ImageArena
+{
+public:
+	static void* Allocate(size_t size);
+	static void* Reallocate(void* block, size_t size);
+	static void Free(void* block);
+
+	// Releases everything allocated on this thread and returns the counts of
+	// what happened since the previous reset.
+	static ImageArenaStats Reset();
+	// Returns the thread's memory to the heap as well.
+	static void Release();
+};
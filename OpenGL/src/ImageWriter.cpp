@@ -0,0 +1,314 @@
+#include "ImageWriter.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+	struct CRCTable
+	{
+		unsigned int Entries[256];
+
+		CRCTable()
+		{
+			for (unsigned int n = 0; n < 256; n++)
+			{
+				unsigned int c = n;
+				for (int k = 0; k < 8; k++)
+					c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+				Entries[n] = c;
+			}
+		}
+	};
+
+	unsigned int CRC32(const unsigned char* data, size_t size, unsigned int crc = 0)
+	{
+		// Function-local so the table is built once even with several writer threads.
+		static const CRCTable table;
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+			crc = table.Entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	unsigned int Adler32(const unsigned char* data, size_t size)
+	{
+		unsigned int a = 1, b = 0;
+		while (size > 0)
+		{
+			// Largest block that can't overflow before the modulo.
+			size_t block = size < 5552 ? size : 5552;
+			size -= block;
+			while (block--)
+			{
+				a += *data++;
+				b += a;
+			}
+			a %= 65521;
+			b %= 65521;
+		}
+		return (b << 16) | a;
+	}
+
+	class BitWriter
+	{
+	private:
+		std::vector<unsigned char>& m_Out;
+		unsigned int m_Bits;
+		int m_Count;
+	public:
+		BitWriter(std::vector<unsigned char>& out) : m_Out(out), m_Bits(0), m_Count(0) {}
+
+		// Deflate packs values LSB first.
+		void Write(unsigned int value, int count)
+		{
+			m_Bits |= value << m_Count;
+			m_Count += count;
+			while (m_Count >= 8)
+			{
+				m_Out.push_back((unsigned char)m_Bits);
+				m_Bits >>= 8;
+				m_Count -= 8;
+			}
+		}
+
+		// Huffman codes are defined MSB first.
+		void WriteCode(unsigned int code, int count)
+		{
+			unsigned int reversed = 0;
+			for (int i = 0; i < count; i++)
+				reversed |= ((code >> i) & 1) << (count - 1 - i);
+			Write(reversed, count);
+		}
+
+		void Flush()
+		{
+			if (m_Count > 0)
+				Write(0, 8 - m_Count);
+		}
+	};
+
+	const int LengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const int LengthExtra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const int DistBase[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const int DistExtra[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	// Fixed literal/length code from RFC 1951, 3.2.6.
+	void WriteLiteral(BitWriter& bits, int symbol)
+	{
+		if (symbol < 144)
+			bits.WriteCode(0x30 + symbol, 8);
+		else if (symbol < 256)
+			bits.WriteCode(0x190 + symbol - 144, 9);
+		else if (symbol < 280)
+			bits.WriteCode(symbol - 256, 7);
+		else
+			bits.WriteCode(0xc0 + symbol - 280, 8);
+	}
+
+	void WriteMatch(BitWriter& bits, int length, int distance)
+	{
+		int i = 28;
+		while (LengthBase[i] > length)
+			i--;
+		WriteLiteral(bits, 257 + i);
+		if (LengthExtra[i])
+			bits.Write(length - LengthBase[i], LengthExtra[i]);
+
+		i = 29;
+		while (DistBase[i] > distance)
+			i--;
+		bits.WriteCode(i, 5);
+		if (DistExtra[i])
+			bits.Write(distance - DistBase[i], DistExtra[i]);
+	}
+
+	// One fixed-Huffman block. Matches come from a hash of the next three
+	// bytes that remembers only the last position, which finds the long runs
+	// frames are full of at a fraction of the cost of proper chains.
+	void Deflate(const unsigned char* data, size_t size, std::vector<unsigned char>& out)
+	{
+		const int HashBits = 15;
+		const size_t Window = 32768;
+		std::vector<int> head(1 << HashBits, -1);
+
+		BitWriter bits(out);
+		bits.Write(1, 1); // Final block
+		bits.Write(1, 2); // Fixed Huffman
+
+		size_t i = 0;
+		while (i < size)
+		{
+			int length = 0;
+			size_t match = 0;
+			if (i + 3 <= size)
+			{
+				unsigned int hash = ((data[i] << 16) | (data[i + 1] << 8) | data[i + 2]) * 2654435761u >> (32 - HashBits);
+				int candidate = head[hash];
+				head[hash] = (int)i;
+				if (candidate >= 0 && i - candidate <= Window)
+				{
+					size_t limit = size - i < 258 ? size - i : 258;
+					while ((size_t)length < limit && data[candidate + length] == data[i + length])
+						length++;
+					match = candidate;
+				}
+			}
+
+			if (length >= 3)
+			{
+				WriteMatch(bits, length, (int)(i - match));
+				i += length;
+			}
+			else
+			{
+				WriteLiteral(bits, data[i]);
+				i++;
+			}
+		}
+		WriteLiteral(bits, 256);
+		bits.Flush();
+	}
+
+	int Paeth(int a, int b, int c)
+	{
+		int p = a + b - c;
+		int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+		if (pa <= pb && pa <= pc)
+			return a;
+		return pb <= pc ? b : c;
+	}
+
+	void WriteChunk(std::vector<unsigned char>& png, const char* type, const unsigned char* data, unsigned int size)
+	{
+		unsigned char header[8] = { (unsigned char)(size >> 24), (unsigned char)(size >> 16), (unsigned char)(size >> 8), (unsigned char)size,
+			(unsigned char)type[0], (unsigned char)type[1], (unsigned char)type[2], (unsigned char)type[3] };
+		png.insert(png.end(), header, header + 8);
+		png.insert(png.end(), data, data + size);
+		unsigned int crc = CRC32(data, size, CRC32(header + 4, 4));
+		unsigned char footer[4] = { (unsigned char)(crc >> 24), (unsigned char)(crc >> 16), (unsigned char)(crc >> 8), (unsigned char)crc };
+		png.insert(png.end(), footer, footer + 4);
+	}
+
+}
+
+namespace ImageWriter
+{
+	bool EncodePNG(const unsigned char* pixels, int width, int height, int channels, bool flipY, std::vector<unsigned char>& png)
+	{
+		if (width <= 0 || height <= 0 || channels < 1 || channels > 4)
+			return false;
+
+		size_t stride = (size_t)width * channels;
+		std::vector<unsigned char> filtered((stride + 1) * height);
+		std::vector<unsigned char> candidate(stride);
+		for (int y = 0; y < height; y++)
+		{
+			const unsigned char* row = pixels + stride * (flipY ? height - 1 - y : y);
+			const unsigned char* prior = y == 0 ? nullptr : pixels + stride * (flipY ? height - y : y - 1);
+			unsigned char* out = &filtered[(stride + 1) * y];
+
+			int bestSum = -1;
+			for (int filter = 0; filter < 5; filter++)
+			{
+				int sum = 0;
+				for (size_t i = 0; i < stride; i++)
+				{
+					int a = i >= (size_t)channels ? row[i - channels] : 0;
+					int b = prior ? prior[i] : 0;
+					int c = prior && i >= (size_t)channels ? prior[i - channels] : 0;
+					int predicted = filter == 1 ? a : filter == 2 ? b : filter == 3 ? (a + b) / 2 : filter == 4 ? Paeth(a, b, c) : 0;
+					candidate[i] = (unsigned char)(row[i] - predicted);
+					sum += (signed char)candidate[i] < 0 ? -(signed char)candidate[i] : candidate[i];
+				}
+				if (bestSum < 0 || sum < bestSum)
+				{
+					bestSum = sum;
+					out[0] = (unsigned char)filter;
+					memcpy(out + 1, candidate.data(), stride);
+				}
+			}
+		}
+
+		std::vector<unsigned char> zlib = { 0x78, 0x01 };
+		Deflate(filtered.data(), filtered.size(), zlib);
+		unsigned int adler = Adler32(filtered.data(), filtered.size());
+		unsigned char trailer[4] = { (unsigned char)(adler >> 24), (unsigned char)(adler >> 16), (unsigned char)(adler >> 8), (unsigned char)adler };
+		zlib.insert(zlib.end(), trailer, trailer + 4);
+
+		static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+		static const unsigned char colorTypes[5] = { 0, 0, 4, 2, 6 };
+		unsigned char header[13] = { (unsigned char)(width >> 24), (unsigned char)(width >> 16), (unsigned char)(width >> 8), (unsigned char)width,
+			(unsigned char)(height >> 24), (unsigned char)(height >> 16), (unsigned char)(height >> 8), (unsigned char)height,
+			8, colorTypes[channels], 0, 0, 0 };
+
+		png.assign(signature, signature + 8);
+		WriteChunk(png, "IHDR", header, 13);
+		WriteChunk(png, "IDAT", zlib.data(), (unsigned int)zlib.size());
+		WriteChunk(png, "IEND", nullptr, 0);
+		return true;
+	}
+
+	bool WritePNG(const std::string& path, const unsigned char* pixels, int width, int height, int channels, bool flipY)
+	{
+		std::vector<unsigned char> png;
+		if (!EncodePNG(pixels, width, height, channels, flipY, png))
+			return false;
+
+		std::ofstream stream(path, std::ios::binary);
+		stream.write((const char*)png.data(), png.size());
+		if (!stream)
+		{
+			std::cout << "Failed to write '" << path << "'" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	void ConvertToYUV420(const unsigned char* rgba, int width, int height, bool flipY, std::vector<unsigned char>& yuv)
+	{
+		int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+		yuv.resize((size_t)width * height + 2 * (size_t)chromaWidth * chromaHeight);
+		unsigned char* planeY = yuv.data();
+		unsigned char* planeU = planeY + (size_t)width * height;
+		unsigned char* planeV = planeU + (size_t)chromaWidth * chromaHeight;
+
+		// Fixed point, 16 fractional bits.
+		for (int y = 0; y < height; y++)
+		{
+			const unsigned char* row = rgba + (size_t)width * 4 * (flipY ? height - 1 - y : y);
+			for (int x = 0; x < width; x++)
+			{
+				const unsigned char* p = row + x * 4;
+				planeY[(size_t)y * width + x] = (unsigned char)((19595 * p[0] + 38470 * p[1] + 7471 * p[2] + 32768) >> 16);
+			}
+		}
+
+		for (int cy = 0; cy < chromaHeight; cy++)
+		{
+			for (int cx = 0; cx < chromaWidth; cx++)
+			{
+				// Average of the 2x2 block, clamped at odd edges.
+				int r = 0, g = 0, b = 0;
+				for (int dy = 0; dy < 2; dy++)
+				{
+					int sy = cy * 2 + dy < height ? cy * 2 + dy : height - 1;
+					const unsigned char* row = rgba + (size_t)width * 4 * (flipY ? height - 1 - sy : sy);
+					for (int dx = 0; dx < 2; dx++)
+					{
+						int sx = cx * 2 + dx < width ? cx * 2 + dx : width - 1;
+						r += row[sx * 4 + 0];
+						g += row[sx * 4 + 1];
+						b += row[sx * 4 + 2];
+					}
+				}
+				int u = (-11059 * r - 21709 * g + 32768 * b + (128 << 18) + (1 << 17)) >> 18;
+				int v = (32768 * r - 27439 * g - 5329 * b + (128 << 18) + (1 << 17)) >> 18;
+				planeU[(size_t)cy * chromaWidth + cx] = (unsigned char)(u < 0 ? 0 : u > 255 ? 255 : u);
+				planeV[(size_t)cy * chromaWidth + cx] = (unsigned char)(v < 0 ? 0 : v > 255 ? 255 : v);
+			}
+		}
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Minimal encoders for dumping frames and debug images; nothing here reads
+// files back (stb_image does that).
+namespace ImageWriter
+{
+	// 8-bit PNG with 1 to 4 channels. Each row gets the PNG filter with the
+	// smallest sum of residuals, then fixed-Huffman deflate with a small LZ77
+	// window: a few times larger than a tuned encoder, a lot faster to write.
+	// flipY for rows stored bottom to top, the way GL returns them.
+	bool EncodePNG(const unsigned char* pixels, int width, int height, int channels, bool flipY, std::vector<unsigned char>& png);
+	bool WritePNG(const std::string& path, const unsigned char* pixels, int width, int height, int channels, bool flipY = false);
+
+	// One 4:2:0 frame (Y, then Cb and Cr at half resolution) from RGBA pixels,
+	// BT.601 full range as in the Y4M "C420jpeg" colorspace.
+	void ConvertToYUV420(const unsigned char* rgba, int width, int height, bool flipY, std::vector<unsigned char>& yuv);
+}
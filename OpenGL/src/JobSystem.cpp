@@ -0,0 +1,300 @@
+#include "JobSystem.h"
+
+// Which system, and which of its deques, the current thread belongs to.
+static thread_local JobSystem* t_System = nullptr;
+static thread_local void* t_Worker = nullptr;
+
+JobSystem::JobDeque::JobDeque()
+	: m_Top(0), m_Bottom(0), m_Jobs(new std::atomic<Job*>[QueueSize])
+{
+}
+
+// Memory orders follow Le, Pop, Cohen and Zappa Nardelli, "Correct and
+// Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+bool JobSystem::JobDeque::Push(Job* job)
+{
+	long long bottom = m_Bottom.load(std::memory_order_relaxed);
+	long long top = m_Top.load(std::memory_order_acquire);
+	if (bottom - top >= (long long)QueueSize)
+		return false;
+
+	m_Jobs[bottom & (QueueSize - 1)].store(job, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+	return true;
+}
+
+JobSystem::Job* JobSystem::JobDeque::Pop()
+{
+	long long bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+	m_Bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long top = m_Top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = m_Jobs[bottom & (QueueSize - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		// Last job: race the thieves for it.
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+JobSystem::Job* JobSystem::JobDeque::Steal()
+{
+	long long top = m_Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long bottom = m_Bottom.load(std::memory_order_acquire);
+	if (top >= bottom)
+		return nullptr;
+
+	Job* job = m_Jobs[top & (QueueSize - 1)].load(std::memory_order_relaxed);
+	if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr; // Lost to the owner or another thief
+	return job;
+}
+
+JobSystem::JobSystem(unsigned int threads)
+	: m_Queued(0), m_Sleeping(0), m_Quit(false), m_ExternalCount(0), m_BackgroundCount(0)
+{
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if (threads < 2)
+		threads = 2;
+
+	for (unsigned int i = 0; i < threads; i++)
+	{
+		std::unique_ptr<Worker> worker(new Worker());
+		worker->Jobs.reset(new Job[QueueSize]);
+		for (unsigned int j = 0; j < QueueSize; j++)
+			worker->Jobs[j].Busy.store(false, std::memory_order_relaxed);
+		worker->NextJob = 0;
+		worker->Random = 2654435761u * (i + 1);
+		m_Workers.push_back(std::move(worker));
+	}
+
+	t_System = this;
+	t_Worker = m_Workers[0].get();
+	for (unsigned int i = 1; i < threads; i++)
+		m_Threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	// Jobs still queued hold pointers to counters their owners may be
+	// about to destroy, so drain everything before stopping.
+	for (;;)
+	{
+		if (m_Queued.load() == 0 && m_ExternalCount.load() == 0 && m_BackgroundCount.load() == 0)
+			break;
+		if (!RunOne(m_Workers[0].get(), true))
+			std::this_thread::yield();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Quit = true;
+	}
+	m_Wake.notify_all();
+	for (std::thread& thread : m_Threads)
+		thread.join();
+
+	if (t_System == this)
+	{
+		t_System = nullptr;
+		t_Worker = nullptr;
+	}
+}
+
+JobSystem::Worker* JobSystem::GetWorker() const
+{
+	return t_System == this ? (Worker*)t_Worker : nullptr;
+}
+
+void JobSystem::Run(JobCounter& counter, std::function<void()> function)
+{
+	counter.m_Count.fetch_add(1, std::memory_order_relaxed);
+
+	Worker* worker = GetWorker();
+	if (!worker)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_ExternalMutex);
+			m_External.push_back({ std::move(function), &counter });
+			m_ExternalCount.fetch_add(1);
+		}
+		m_Queued.fetch_add(1);
+		WakeWorker();
+		return;
+	}
+
+	// A slot still in use means this thread has a full ring of jobs in
+	// flight; running the new one here is the simplest back pressure.
+	Job& job = worker->Jobs[worker->NextJob++ & (QueueSize - 1)];
+	if (job.Busy.load(std::memory_order_acquire))
+	{
+		function();
+		counter.m_Count.fetch_sub(1, std::memory_order_acq_rel);
+		return;
+	}
+
+	job.Function = std::move(function);
+	job.Counter = &counter;
+	job.Busy.store(true, std::memory_order_relaxed);
+
+	// Counted before it becomes visible so a worker going to sleep can't miss it.
+	m_Queued.fetch_add(1);
+	if (!worker->Queue.Push(&job))
+	{
+		m_Queued.fetch_sub(1);
+		Execute(&job);
+		return;
+	}
+	WakeWorker();
+}
+
+void JobSystem::RunBackground(JobCounter& counter, std::function<void()> function)
+{
+	counter.m_Count.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock(m_ExternalMutex);
+		m_Background.push_back({ std::move(function), &counter });
+		m_BackgroundCount.fetch_add(1);
+	}
+	m_Queued.fetch_add(1);
+	WakeWorker();
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	Worker* worker = GetWorker();
+	while (!counter.IsDone())
+	{
+		if (!worker || !RunOne(worker))
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int grain, const std::function<void(unsigned int, unsigned int)>& body)
+{
+	if (count == 0)
+		return;
+	if (grain == 0)
+	{
+		grain = count / (GetThreadCount() * 4);
+		if (grain == 0)
+			grain = 1;
+	}
+
+	JobCounter counter;
+	for (unsigned int begin = 0; begin < count; begin += grain)
+	{
+		unsigned int end = count - begin > grain ? begin + grain : count;
+		Run(counter, [&body, begin, end] { body(begin, end); });
+	}
+	Wait(counter);
+}
+
+bool JobSystem::RunOne(Worker* worker, bool background)
+{
+	Job* job = worker->Queue.Pop();
+	if (!job)
+	{
+		// Start at a random victim so thieves spread out.
+		unsigned int count = (unsigned int)m_Workers.size();
+		worker->Random ^= worker->Random << 13;
+		worker->Random ^= worker->Random >> 17;
+		worker->Random ^= worker->Random << 5;
+		for (unsigned int i = 0, victim = worker->Random % count; i < count && !job; i++, victim = (victim + 1) % count)
+		{
+			if (m_Workers[victim].get() != worker)
+				job = m_Workers[victim]->Queue.Steal();
+		}
+	}
+	if (job)
+	{
+		m_Queued.fetch_sub(1);
+		Execute(job);
+		return true;
+	}
+
+	// Checked without the lock first: spinning workers and Wait come
+	// through here all the time, and both queues are usually empty.
+	bool fromExternal = m_ExternalCount.load(std::memory_order_relaxed) > 0;
+	if (!fromExternal && !(background && m_BackgroundCount.load(std::memory_order_relaxed) > 0))
+		return false;
+
+	ExternalJob external;
+	{
+		std::lock_guard<std::mutex> lock(m_ExternalMutex);
+		fromExternal = !m_External.empty();
+		if (!fromExternal && !(background && !m_Background.empty()))
+			return false;
+		std::deque<ExternalJob>& queue = fromExternal ? m_External : m_Background;
+		external = std::move(queue.front());
+		queue.pop_front();
+		(fromExternal ? m_ExternalCount : m_BackgroundCount).fetch_sub(1);
+	}
+	m_Queued.fetch_sub(1);
+	external.Function();
+	external.Counter->m_Count.fetch_sub(1, std::memory_order_acq_rel);
+	return true;
+}
+
+void JobSystem::Execute(Job* job)
+{
+	// Hand the slot back before running, the owner may reuse it from here on.
+	std::function<void()> function = std::move(job->Function);
+	JobCounter* counter = job->Counter;
+	job->Function = nullptr;
+	job->Busy.store(false, std::memory_order_release);
+
+	function();
+	counter->m_Count.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void JobSystem::WakeWorker()
+{
+	if (m_Sleeping.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Wake.notify_one();
+	}
+}
+
+void JobSystem::WorkerLoop(unsigned int index)
+{
+	Worker* worker = m_Workers[index].get();
+	t_System = this;
+	t_Worker = worker;
+
+	unsigned int idle = 0;
+	while (!m_Quit.load(std::memory_order_relaxed))
+	{
+		if (RunOne(worker, true))
+		{
+			idle = 0;
+			continue;
+		}
+		// Spin a little first, new work usually follows soon within a frame.
+		if (++idle < 64)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_Sleeping.fetch_add(1);
+		m_Wake.wait(lock, [this] { return m_Quit.load() || m_Queued.load() > 0; });
+		m_Sleeping.fetch_sub(1);
+		idle = 0;
+	}
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts the jobs started with it that have not finished yet. Wait on it to
+// join them; a job can start more jobs on the same counter before it returns.
+class JobCounter
+{
+private:
+	std::atomic<int> m_Count;
+public:
+	JobCounter() : m_Count(0) {}
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	inline bool IsDone() const { return m_Count.load(std::memory_order_acquire) == 0; }
+
+	friend class JobSystem;
+};
+
+// Work-stealing scheduler. Every thread of the system, including the one that
+// created it, owns a Chase-Lev deque: it pushes and pops its own jobs at the
+// bottom without locks while idle threads steal from the top of the others.
+// Jobs started from other threads go through a locked queue.
+//
+// Long or blocking work (file I/O, image decoding) goes through RunBackground
+// instead. Only the worker threads pick those up, so a Wait on the render
+// thread never ends up running a whole decode in the middle of a frame.
+//
+// Waiting runs other jobs instead of blocking, so a job may wait for the jobs
+// it started; that is how dependencies are expressed:
+//
+//	JobCounter culled;
+//	for (auto& batch : batches)
+//		jobs.Run(culled, [&batch] { Cull(batch); });
+//	jobs.Wait(culled);
+class JobSystem
+{
+private:
+	struct Job
+	{
+		std::function<void()> Function;
+		JobCounter* Counter;
+		std::atomic<bool> Busy; // Between Run and the start of the job
+	};
+
+	// Fixed capacity; Run executes the job right away when it is full.
+	class JobDeque
+	{
+	private:
+		std::atomic<long long> m_Top;    // Stolen from here
+		std::atomic<long long> m_Bottom; // Pushed and popped here, owner only
+		std::unique_ptr<std::atomic<Job*>[]> m_Jobs;
+	public:
+		JobDeque();
+
+		bool Push(Job* job);
+		Job* Pop();
+		Job* Steal();
+	};
+
+	struct Worker
+	{
+		JobDeque Queue;
+		std::unique_ptr<Job[]> Jobs; // Ring the worker allocates its jobs from
+		unsigned int NextJob;
+		unsigned int Random;         // Picks steal victims
+	};
+
+	struct ExternalJob
+	{
+		std::function<void()> Function;
+		JobCounter* Counter;
+	};
+
+	std::vector<std::unique_ptr<Worker>> m_Workers; // [0] is the creating thread
+	std::vector<std::thread> m_Threads;
+	std::atomic<int> m_Queued;   // Pushed but not started, for sleeping workers
+	std::atomic<int> m_Sleeping;
+	std::atomic<bool> m_Quit;
+	std::mutex m_SleepMutex;
+	std::condition_variable m_Wake;
+
+	std::mutex m_ExternalMutex;
+	std::deque<ExternalJob> m_External;
+	std::deque<ExternalJob> m_Background; // Also under m_ExternalMutex
+	// Sizes of the two queues, so idle threads only take the lock when
+	// there is something to take.
+	std::atomic<int> m_ExternalCount;
+	std::atomic<int> m_BackgroundCount;
+public:
+	// threads counts the creating thread; 0 uses one per core. There is always
+	// at least one worker thread so jobs progress while nobody waits.
+	JobSystem(unsigned int threads = 0);
+	~JobSystem(); // Finishes the jobs already started
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	void Run(JobCounter& counter, std::function<void()> function);
+	// Runs on a worker thread once it has nothing else to do; never from Wait.
+	// Don't wait for these from inside a job: every worker could end up
+	// waiting with nobody left to run them.
+	void RunBackground(JobCounter& counter, std::function<void()> function);
+	// Runs jobs until the counter drops to zero.
+	void Wait(JobCounter& counter);
+
+	// Calls body(begin, end) over [0, count) in chunks of grain items, spread
+	// over all threads, and returns when every chunk is done. A grain of 0
+	// picks about four chunks per thread.
+	void ParallelFor(unsigned int count, unsigned int grain, const std::function<void(unsigned int, unsigned int)>& body);
+
+	inline unsigned int GetThreadCount() const { return (unsigned int)m_Workers.size(); }
+
+	static const unsigned int QueueSize = 4096; // Power of two
+private:
+	Worker* GetWorker() const;
+	bool RunOne(Worker* worker, bool background = false);
+	void Execute(Job* job);
+	void WakeWorker();
+	void WorkerLoop(unsigned int index);
+};
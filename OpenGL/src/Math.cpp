@@ -0,0 +1,235 @@
+#include "Math.h"
+
+#if defined(MATH_SSE) && defined(__AVX__)
+#define MATH_AVX 1
+#include <immintrin.h>
+#endif
+
+Mat4 Mat4::Orthographic(float left, float right, float bottom, float top, float zNear, float zFar)
+{
+	Mat4 result = Identity();
+	result.m[0] = 2.0f / (right - left);
+	result.m[5] = 2.0f / (top - bottom);
+	result.m[10] = -2.0f / (zFar - zNear);
+	result.m[12] = -(right + left) / (right - left);
+	result.m[13] = -(top + bottom) / (top - bottom);
+	result.m[14] = -(zFar + zNear) / (zFar - zNear);
+	return result;
+}
+
+Mat4 Mat4::Perspective(float fovY, float aspect, float zNear, float zFar)
+{
+	float f = 1.0f / std::tan(fovY * 0.5f);
+	Mat4 result = { {} };
+	result.m[0] = f / aspect;
+	result.m[5] = f;
+	result.m[10] = (zFar + zNear) / (zNear - zFar);
+	result.m[11] = -1.0f;
+	result.m[14] = 2.0f * zFar * zNear / (zNear - zFar);
+	return result;
+}
+
+Mat4 Mat4::LookAt(const Vec3& eye, const Vec3& target, const Vec3& up)
+{
+	Vec3 forward = Normalize(target - eye);
+	Vec3 side = Normalize(Cross(forward, up));
+	Vec3 upward = Cross(side, forward);
+	return { {
+		side.x, upward.x, -forward.x, 0.0f,
+		side.y, upward.y, -forward.y, 0.0f,
+		side.z, upward.z, -forward.z, 0.0f,
+		-Dot(side, eye), -Dot(upward, eye), Dot(forward, eye), 1.0f
+	} };
+}
+
+Mat4 Transpose(const Mat4& a)
+{
+	Mat4 result;
+	for (int column = 0; column < 4; column++)
+	{
+		for (int row = 0; row < 4; row++)
+			result.m[column * 4 + row] = a.m[row * 4 + column];
+	}
+	return result;
+}
+
+Mat4 Inverse(const Mat4& a)
+{
+	// Cofactors from 2x2 sub-determinants of the top and bottom row pairs.
+	const float* m = a.m;
+	float s0 = m[0] * m[5] - m[4] * m[1];
+	float s1 = m[0] * m[9] - m[8] * m[1];
+	float s2 = m[0] * m[13] - m[12] * m[1];
+	float s3 = m[4] * m[9] - m[8] * m[5];
+	float s4 = m[4] * m[13] - m[12] * m[5];
+	float s5 = m[8] * m[13] - m[12] * m[9];
+	float c5 = m[10] * m[15] - m[14] * m[11];
+	float c4 = m[6] * m[15] - m[14] * m[7];
+	float c3 = m[6] * m[11] - m[10] * m[7];
+	float c2 = m[2] * m[15] - m[14] * m[3];
+	float c1 = m[2] * m[11] - m[10] * m[3];
+	float c0 = m[2] * m[7] - m[6] * m[3];
+
+	float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	if (determinant == 0.0f)
+		return { {} };
+	float d = 1.0f / determinant;
+
+	return { {
+		(m[5] * c5 - m[9] * c4 + m[13] * c3) * d,
+		(-m[1] * c5 + m[9] * c2 - m[13] * c1) * d,
+		(m[1] * c4 - m[5] * c2 + m[13] * c0) * d,
+		(-m[1] * c3 + m[5] * c1 - m[9] * c0) * d,
+
+		(-m[4] * c5 + m[8] * c4 - m[12] * c3) * d,
+		(m[0] * c5 - m[8] * c2 + m[12] * c1) * d,
+		(-m[0] * c4 + m[4] * c2 - m[12] * c0) * d,
+		(m[0] * c3 - m[4] * c1 + m[8] * c0) * d,
+
+		(m[7] * s5 - m[11] * s4 + m[15] * s3) * d,
+		(-m[3] * s5 + m[11] * s2 - m[15] * s1) * d,
+		(m[3] * s4 - m[7] * s2 + m[15] * s0) * d,
+		(-m[3] * s3 + m[7] * s1 - m[11] * s0) * d,
+
+		(-m[6] * s5 + m[10] * s4 - m[14] * s3) * d,
+		(m[2] * s5 - m[10] * s2 + m[14] * s1) * d,
+		(-m[2] * s4 + m[6] * s2 - m[14] * s0) * d,
+		(m[2] * s3 - m[6] * s1 + m[10] * s0) * d
+	} };
+}
+
+Frustum::Frustum(const Mat4& viewProjection)
+{
+	// Row 3 plus or minus rows 0, 1 and 2.
+	const float* m = viewProjection.m;
+	for (int i = 0; i < 6; i++)
+	{
+		int row = i / 2;
+		float sign = i % 2 == 0 ? 1.0f : -1.0f;
+		Planes[i] = { m[3] + sign * m[row], m[7] + sign * m[4 + row], m[11] + sign * m[8 + row], m[15] + sign * m[12 + row] };
+	}
+}
+
+bool Frustum::Intersects(const AABB& box) const
+{
+	for (const Vec4& plane : Planes)
+	{
+		// The corner furthest along the plane normal.
+		float x = plane.x > 0.0f ? box.Max.x : box.Min.x;
+		float y = plane.y > 0.0f ? box.Max.y : box.Min.y;
+		float z = plane.z > 0.0f ? box.Max.z : box.Min.z;
+		if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+namespace Math
+{
+	void MultiplyScalar(const Mat4& a, const Mat4* b, Mat4* out, unsigned int count)
+	{
+		for (unsigned int i = 0; i < count; i++)
+		{
+			Mat4 result;
+			for (int column = 0; column < 4; column++)
+			{
+				for (int row = 0; row < 4; row++)
+				{
+					result.m[column * 4 + row] = a.m[row] * b[i].m[column * 4] + a.m[4 + row] * b[i].m[column * 4 + 1]
+						+ a.m[8 + row] * b[i].m[column * 4 + 2] + a.m[12 + row] * b[i].m[column * 4 + 3];
+				}
+			}
+			out[i] = result;
+		}
+	}
+
+	void Multiply(const Mat4& a, const Mat4* b, Mat4* out, unsigned int count)
+	{
+#if defined(MATH_AVX)
+		// Two columns per register: a's columns in both halves, each half
+		// weighted by its own column of b.
+		__m256 a0 = _mm256_broadcast_ps((const __m128*)&a.m[0]);
+		__m256 a1 = _mm256_broadcast_ps((const __m128*)&a.m[4]);
+		__m256 a2 = _mm256_broadcast_ps((const __m128*)&a.m[8]);
+		__m256 a3 = _mm256_broadcast_ps((const __m128*)&a.m[12]);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			__m256 lo = _mm256_loadu_ps(&b[i].m[0]);
+			__m256 hi = _mm256_loadu_ps(&b[i].m[8]);
+			__m256 r0 = _mm256_mul_ps(a0, _mm256_shuffle_ps(lo, lo, 0x00));
+			r0 = _mm256_add_ps(r0, _mm256_mul_ps(a1, _mm256_shuffle_ps(lo, lo, 0x55)));
+			r0 = _mm256_add_ps(r0, _mm256_mul_ps(a2, _mm256_shuffle_ps(lo, lo, 0xAA)));
+			r0 = _mm256_add_ps(r0, _mm256_mul_ps(a3, _mm256_shuffle_ps(lo, lo, 0xFF)));
+			__m256 r1 = _mm256_mul_ps(a0, _mm256_shuffle_ps(hi, hi, 0x00));
+			r1 = _mm256_add_ps(r1, _mm256_mul_ps(a1, _mm256_shuffle_ps(hi, hi, 0x55)));
+			r1 = _mm256_add_ps(r1, _mm256_mul_ps(a2, _mm256_shuffle_ps(hi, hi, 0xAA)));
+			r1 = _mm256_add_ps(r1, _mm256_mul_ps(a3, _mm256_shuffle_ps(hi, hi, 0xFF)));
+			_mm256_storeu_ps(&out[i].m[0], r0);
+			_mm256_storeu_ps(&out[i].m[8], r1);
+		}
+#elif defined(MATH_SSE)
+		__m128 a0 = _mm_loadu_ps(&a.m[0]), a1 = _mm_loadu_ps(&a.m[4]), a2 = _mm_loadu_ps(&a.m[8]), a3 = _mm_loadu_ps(&a.m[12]);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			__m128 c[4] = { _mm_loadu_ps(&b[i].m[0]), _mm_loadu_ps(&b[i].m[4]), _mm_loadu_ps(&b[i].m[8]), _mm_loadu_ps(&b[i].m[12]) };
+			for (int column = 0; column < 4; column++)
+			{
+				__m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(c[column], c[column], 0x00));
+				r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(c[column], c[column], 0x55)));
+				r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(c[column], c[column], 0xAA)));
+				r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(c[column], c[column], 0xFF)));
+				_mm_storeu_ps(&out[i].m[column * 4], r);
+			}
+		}
+#else
+		MultiplyScalar(a, b, out, count);
+#endif
+	}
+
+	void TransformPointsScalar(const Mat4& matrix, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, unsigned int count)
+	{
+		const float* m = matrix.m;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			float px = x[i], py = y[i], pz = z[i];
+			outX[i] = m[0] * px + m[4] * py + m[8] * pz + m[12];
+			outY[i] = m[1] * px + m[5] * py + m[9] * pz + m[13];
+			outZ[i] = m[2] * px + m[6] * py + m[10] * pz + m[14];
+		}
+	}
+
+	void TransformPoints(const Mat4& matrix, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, unsigned int count)
+	{
+		const float* m = matrix.m;
+		unsigned int i = 0;
+#if defined(MATH_AVX)
+		__m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2 = _mm256_set1_ps(m[2]);
+		__m256 m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]), m6 = _mm256_set1_ps(m[6]);
+		__m256 m8 = _mm256_set1_ps(m[8]), m9 = _mm256_set1_ps(m[9]), m10 = _mm256_set1_ps(m[10]);
+		__m256 m12 = _mm256_set1_ps(m[12]), m13 = _mm256_set1_ps(m[13]), m14 = _mm256_set1_ps(m[14]);
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 px = _mm256_loadu_ps(&x[i]), py = _mm256_loadu_ps(&y[i]), pz = _mm256_loadu_ps(&z[i]);
+			_mm256_storeu_ps(&outX[i], _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, px), _mm256_mul_ps(m4, py)), _mm256_add_ps(_mm256_mul_ps(m8, pz), m12)));
+			_mm256_storeu_ps(&outY[i], _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m1, px), _mm256_mul_ps(m5, py)), _mm256_add_ps(_mm256_mul_ps(m9, pz), m13)));
+			_mm256_storeu_ps(&outZ[i], _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m2, px), _mm256_mul_ps(m6, py)), _mm256_add_ps(_mm256_mul_ps(m10, pz), m14)));
+		}
+#elif defined(MATH_SSE)
+		__m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+		__m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]);
+		__m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+		__m128 m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]), m14 = _mm_set1_ps(m[14]);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 px = _mm_loadu_ps(&x[i]), py = _mm_loadu_ps(&y[i]), pz = _mm_loadu_ps(&z[i]);
+			_mm_storeu_ps(&outX[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, px), _mm_mul_ps(m4, py)), _mm_add_ps(_mm_mul_ps(m8, pz), m12)));
+			_mm_storeu_ps(&outY[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, px), _mm_mul_ps(m5, py)), _mm_add_ps(_mm_mul_ps(m9, pz), m13)));
+			_mm_storeu_ps(&outZ[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, px), _mm_mul_ps(m6, py)), _mm_add_ps(_mm_mul_ps(m10, pz), m14)));
+		}
+#endif
+		// Whatever doesn't fill a whole register.
+		TransformPointsScalar(matrix, x + i, y + i, z + i, outX + i, outY + i, outZ + i, count - i);
+	}
+}
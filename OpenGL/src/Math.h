@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cmath>
+
+// SSE is part of every x64 target; MATH_NO_SIMD forces the scalar code, e.g.
+// to compare results. Math.cpp also has AVX batch kernels when built with
+// /arch:AVX (-mavx).
+#if !defined(MATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MATH_SSE 1
+#include <xmmintrin.h>
+#endif
+
+struct Vec3
+{
+	float x, y, z;
+};
+
+inline Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+inline Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+inline Vec3 operator-(const Vec3& a) { return { -a.x, -a.y, -a.z }; }
+inline Vec3 operator*(const Vec3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+inline Vec3 operator*(const Vec3& a, const Vec3& b) { return { a.x * b.x, a.y * b.y, a.z * b.z }; }
+
+inline float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3 Cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+inline float Length(const Vec3& a) { return std::sqrt(Dot(a, a)); }
+inline Vec3 Normalize(const Vec3& a)
+{
+	float length = Length(a);
+	return length > 0.0f ? a * (1.0f / length) : a;
+}
+
+struct Vec4
+{
+	float x, y, z, w;
+};
+
+// Unit quaternion.
+struct Quat
+{
+	float x, y, z, w;
+
+	static inline Quat Identity() { return { 0.0f, 0.0f, 0.0f, 1.0f }; }
+	static inline Quat FromAxisAngle(const Vec3& axis, float radians)
+	{
+		float s = std::sin(radians * 0.5f);
+		return { axis.x * s, axis.y * s, axis.z * s, std::cos(radians * 0.5f) };
+	}
+};
+
+// a * b rotates by b first, then by a.
+inline Quat operator*(const Quat& a, const Quat& b)
+{
+	return {
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+	};
+}
+
+inline Quat Conjugate(const Quat& q) { return { -q.x, -q.y, -q.z, q.w }; }
+
+inline Quat Normalize(const Quat& q)
+{
+	float length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+	float s = length > 0.0f ? 1.0f / length : 0.0f;
+	return { q.x * s, q.y * s, q.z * s, q.w * s };
+}
+
+inline Vec3 Rotate(const Quat& q, const Vec3& v)
+{
+	// v + 2w(u x v) + 2u x (u x v), with u the vector part.
+	Vec3 u = { q.x, q.y, q.z };
+	Vec3 t = Cross(u, v) * 2.0f;
+	return v + t * q.w + Cross(u, t);
+}
+
+// Normalized lerp along the shorter arc. Not constant speed like a slerp, but
+// close for the small steps of interpolating between two simulation states.
+inline Quat Nlerp(const Quat& a, const Quat& b, float t)
+{
+	float sign = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.0f ? -1.0f : 1.0f;
+	return Normalize({ a.x + (b.x * sign - a.x) * t, a.y + (b.y * sign - a.y) * t, a.z + (b.z * sign - a.z) * t, a.w + (b.w * sign - a.w) * t });
+}
+
+// Column-major, the layout glUniformMatrix4fv takes without transposing.
+struct Mat4
+{
+	float m[16];
+
+	static inline Mat4 Identity()
+	{
+		return { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } };
+	}
+
+	// Scale, then rotate, then translate.
+	static inline Mat4 FromTRS(const Vec3& t, const Quat& r, const Vec3& s)
+	{
+		float xx = r.x * r.x, yy = r.y * r.y, zz = r.z * r.z;
+		float xy = r.x * r.y, xz = r.x * r.z, yz = r.y * r.z;
+		float wx = r.w * r.x, wy = r.w * r.y, wz = r.w * r.z;
+		return { {
+			(1.0f - 2.0f * (yy + zz)) * s.x, 2.0f * (xy + wz) * s.x, 2.0f * (xz - wy) * s.x, 0.0f,
+			2.0f * (xy - wz) * s.y, (1.0f - 2.0f * (xx + zz)) * s.y, 2.0f * (yz + wx) * s.y, 0.0f,
+			2.0f * (xz + wy) * s.z, 2.0f * (yz - wx) * s.z, (1.0f - 2.0f * (xx + yy)) * s.z, 0.0f,
+			t.x, t.y, t.z, 1.0f
+		} };
+	}
+
+	// OpenGL clip space, z from -1 to 1, looking down -z.
+	static Mat4 Orthographic(float left, float right, float bottom, float top, float zNear, float zFar);
+	static Mat4 Perspective(float fovY, float aspect, float zNear, float zFar);
+	static Mat4 LookAt(const Vec3& eye, const Vec3& target, const Vec3& up);
+};
+
+inline Mat4 operator*(const Mat4& a, const Mat4& b)
+{
+	Mat4 result;
+#ifdef MATH_SSE
+	// Each result column is the columns of a weighted by a column of b.
+	__m128 a0 = _mm_loadu_ps(&a.m[0]), a1 = _mm_loadu_ps(&a.m[4]), a2 = _mm_loadu_ps(&a.m[8]), a3 = _mm_loadu_ps(&a.m[12]);
+	for (int column = 0; column < 4; column++)
+	{
+		const float* c = &b.m[column * 4];
+		__m128 r = _mm_mul_ps(a0, _mm_set1_ps(c[0]));
+		r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(c[1])));
+		r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(c[2])));
+		r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(c[3])));
+		_mm_storeu_ps(&result.m[column * 4], r);
+	}
+#else
+	for (int column = 0; column < 4; column++)
+	{
+		for (int row = 0; row < 4; row++)
+		{
+			result.m[column * 4 + row] = a.m[row] * b.m[column * 4] + a.m[4 + row] * b.m[column * 4 + 1]
+				+ a.m[8 + row] * b.m[column * 4 + 2] + a.m[12 + row] * b.m[column * 4 + 3];
+		}
+	}
+#endif
+	return result;
+}
+
+inline Vec4 operator*(const Mat4& a, const Vec4& v)
+{
+	Vec4 result;
+#ifdef MATH_SSE
+	__m128 r = _mm_mul_ps(_mm_loadu_ps(&a.m[0]), _mm_set1_ps(v.x));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&a.m[4]), _mm_set1_ps(v.y)));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&a.m[8]), _mm_set1_ps(v.z)));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&a.m[12]), _mm_set1_ps(v.w)));
+	_mm_storeu_ps(&result.x, r);
+#else
+	result.x = a.m[0] * v.x + a.m[4] * v.y + a.m[8] * v.z + a.m[12] * v.w;
+	result.y = a.m[1] * v.x + a.m[5] * v.y + a.m[9] * v.z + a.m[13] * v.w;
+	result.z = a.m[2] * v.x + a.m[6] * v.y + a.m[10] * v.z + a.m[14] * v.w;
+	result.w = a.m[3] * v.x + a.m[7] * v.y + a.m[11] * v.z + a.m[15] * v.w;
+#endif
+	return result;
+}
+
+Mat4 Transpose(const Mat4& a);
+// Zero matrix when a is singular.
+Mat4 Inverse(const Mat4& a);
+
+// Axis-aligned box; Min above Max is empty.
+struct AABB
+{
+	Vec3 Min, Max;
+
+	static inline AABB Empty() { return { { 1.0f, 1.0f, 1.0f }, { -1.0f, -1.0f, -1.0f } }; }
+	inline bool IsEmpty() const { return Min.x > Max.x; }
+};
+
+// Box around the transformed box (Arvo, Graphics Gems 1990).
+inline AABB Transform(const Mat4& matrix, const AABB& box)
+{
+	if (box.IsEmpty())
+		return box;
+
+	const float* min = &box.Min.x;
+	const float* max = &box.Max.x;
+	float result[6] = { matrix.m[12], matrix.m[13], matrix.m[14], matrix.m[12], matrix.m[13], matrix.m[14] };
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 3; column++)
+		{
+			float a = matrix.m[column * 4 + row] * min[column];
+			float b = matrix.m[column * 4 + row] * max[column];
+			result[row] += a < b ? a : b;
+			result[3 + row] += a < b ? b : a;
+		}
+	}
+	return { { result[0], result[1], result[2] }, { result[3], result[4], result[5] } };
+}
+
+// The six planes of a view-projection matrix (Gribb and Hartmann), pointing in.
+struct Frustum
+{
+	Vec4 Planes[6];
+
+	explicit Frustum(const Mat4& viewProjection);
+	// Conservative: boxes near a corner outside two planes can pass.
+	bool Intersects(const AABB& box) const;
+};
+
+// Batch kernels over many items at once; SSE or AVX where available.
+namespace Math
+{
+	// out[i] = a * b[i]. out may be b.
+	void Multiply(const Mat4& a, const Mat4* b, Mat4* out, unsigned int count);
+	// Points as separate x, y and z arrays, w taken as 1 and not divided by,
+	// so for affine matrices. The output arrays may be the input ones.
+	void TransformPoints(const Mat4& matrix, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, unsigned int count);
+
+	// Reference versions, one item at a time in plain C++.
+	void MultiplyScalar(const Mat4& a, const Mat4* b, Mat4* out, unsigned int count);
+	void TransformPointsScalar(const Mat4& matrix, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, unsigned int count);
+}
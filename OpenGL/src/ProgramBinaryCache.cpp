@@ -0,0 +1,104 @@
+#include "ProgramBinaryCache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "Hash.h"
+#include "Renderer.h"
+
+ProgramBinaryCache::ProgramBinaryCache(const std::string& directory)
+	: m_Directory(directory), m_DriverHash(0), m_Supported(false)
+{
+	int formats = 0;
+	if (GLEW_ARB_get_program_binary)
+	{
+		GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+	}
+	m_Supported = formats > 0;
+
+	m_DriverHash = HashString((const char*)glGetString(GL_VENDOR));
+	m_DriverHash = HashString((const char*)glGetString(GL_RENDERER), m_DriverHash);
+	m_DriverHash = HashString((const char*)glGetString(GL_VERSION), m_DriverHash);
+
+#ifdef _WIN32
+	_mkdir(m_Directory.c_str());
+#else
+	mkdir(m_Directory.c_str(), 0755);
+#endif
+}
+
+unsigned long long ProgramBinaryCache::GetKey(const ShaderProgramSource& source) const
+{
+	unsigned long long hash = HashString(source.VertexSource.c_str(), m_DriverHash);
+	hash = HashString(source.FragmentSource.c_str(), hash);
+	return HashString(source.ComputeSource.c_str(), hash);
+}
+
+std::string ProgramBinaryCache::GetPath(unsigned long long key) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", key);
+	return m_Directory + "/" + name;
+}
+
+unsigned int ProgramBinaryCache::Load(unsigned long long key) const
+{
+	if (!m_Supported)
+		return 0;
+
+	std::ifstream stream(GetPath(key), std::ios::binary);
+	if (!stream)
+		return 0;
+
+	unsigned int format = 0;
+	if (!stream.read((char*)&format, sizeof(format)))
+		return 0;
+	std::vector<char> binary((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	if (binary.empty())
+		return 0;
+
+	unsigned int program = glCreateProgram();
+	glProgramBinary(program, format, binary.data(), (int)binary.size());
+
+	// The driver may reject binaries from another build of itself.
+	int result;
+	glGetProgramiv(program, GL_LINK_STATUS, &result);
+	if (result == GL_FALSE)
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+void ProgramBinaryCache::Store(unsigned long long key, unsigned int program) const
+{
+	if (!m_Supported)
+		return;
+
+	int length = 0;
+	GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+	if (length <= 0)
+		return;
+
+	std::vector<char> binary(length);
+	unsigned int format = 0;
+	GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+
+	std::ofstream stream(GetPath(key), std::ios::binary);
+	if (!stream)
+	{
+		std::cout << "Warning: can't write program binary to '" << GetPath(key) << "'" << std::endl;
+		return;
+	}
+	stream.write((const char*)&format, sizeof(format));
+	stream.write(binary.data(), length);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+struct ShaderProgramSource;
+
+// Stores linked programs on disk with glGetProgramBinary so the next run can
+// skip compiling. Keys are hashes of the final sources plus the driver name and
+// version, so a driver update simply misses the cache.
+class ProgramBinaryCache
+{
+private:
+	std::string m_Directory;
+	unsigned long long m_DriverHash;
+	bool m_Supported;
+public:
+	ProgramBinaryCache(const std::string& directory);
+
+	unsigned long long GetKey(const ShaderProgramSource& source) const;
+
+	// Returns a linked program or 0 when the key is missing or stale.
+	unsigned int Load(unsigned long long key) const;
+	void Store(unsigned long long key, unsigned int program) const;
+
+	inline bool IsSupported() const { return m_Supported; }
+private:
+	std::string GetPath(unsigned long long key) const;
+};
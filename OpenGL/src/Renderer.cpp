@@ -1,6 +1,8 @@
 #include "Renderer.h"
 #include <iostream>
 
+#include "Texture.h"
+
 void GLClearError()
 {
 	while (glGetError() != GL_NO_ERROR);
@@ -16,15 +18,133 @@ bool GLLogCall(const char* function, const char* file, int line)
 	return true;
 }
 
+Renderer::Renderer()
+	: m_Target(nullptr), m_WindowViewport{ 0, 0, 0, 0 }
+{
+}
+
+void Renderer::SetTarget(const Framebuffer* framebuffer)
+{
+	if (!m_Target)
+	{
+		GLCall(glGetIntegerv(GL_VIEWPORT, m_WindowViewport));
+	}
+	m_Target = framebuffer;
+
+	if (m_Target)
+	{
+		m_Target->Bind();
+		GLCall(glViewport(0, 0, m_Target->GetWidth(), m_Target->GetHeight()));
+	}
+	else
+	{
+		GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+		GLCall(glViewport(m_WindowViewport[0], m_WindowViewport[1], m_WindowViewport[2], m_WindowViewport[3]));
+	}
+}
+
 void Renderer::Clear() const
 {
-	GLCall(glClear(GL_COLOR_BUFFER_BIT));
+	// Rebound every time: Framebuffer::Resolve and others change the binding.
+	if (m_Target)
+	{
+		m_Target->Bind();
+		GLCall(glClear(m_Target->GetClearMask()));
+	}
+	else
+	{
+		GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+	}
 }
 
 void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
 {
+	// A ShaderLibrary may still be compiling it; skip instead of waiting.
+	if (!shader.IsReady())
+		return;
+
+	if (m_Target)
+	{
+		m_Target->Bind();
+	}
+	else
+	{
+		GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	}
 	shader.Bind();
 	va.Bind();
 	ib.Bind();
 	GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
 }
+
+unsigned int Renderer::Submit(const Scene& scene, const Mat4& viewProjection) const
+{
+	const std::vector<RenderComponent>& renderables = scene.GetRenderables();
+	const std::vector<AABB>& bounds = scene.GetWorldBounds();
+
+	// All the MVPs in one batch, then draw.
+	m_MVPs.resize(scene.GetCount());
+	Math::Multiply(viewProjection, scene.GetWorldMatrices().data(), m_MVPs.data(), scene.GetCount());
+	Frustum frustum(viewProjection);
+
+	Shader* shader = nullptr;
+	UniformHandle mvp;
+	unsigned int draws = 0;
+	for (unsigned int i = 0; i < renderables.size(); i++)
+	{
+		const RenderComponent& renderable = renderables[i];
+		if (!renderable.Vertices || !renderable.Indices || !renderable.Material)
+			continue;
+		if (!bounds[i].IsEmpty() && !frustum.Intersects(bounds[i]))
+			continue;
+
+		if (renderable.Material != shader)
+		{
+			shader = renderable.Material;
+			mvp = shader->GetUniformHandle("u_MVP");
+			shader->Bind();
+		}
+		shader->SetUniformMat4f(mvp, m_MVPs[i].m);
+		if (renderable.Albedo)
+			renderable.Albedo->Bind();
+
+		Draw(*renderable.Vertices, *renderable.Indices, *shader);
+		draws++;
+	}
+	return draws;
+}
+
+bool Renderer::IsComputeSupported()
+{
+	return GLEW_VERSION_4_3 || GLEW_ARB_compute_shader;
+}
+
+void Renderer::Dispatch(const Shader& shader, unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) const
+{
+	ASSERT(shader.IsCompute());
+	if (!IsComputeSupported())
+	{
+		std::cout << "Warning: compute shaders need OpenGL 4.3" << std::endl;
+		return;
+	}
+	if (!shader.IsReady())
+		return;
+
+	shader.Bind();
+	GLCall(glDispatchCompute(groupsX, groupsY, groupsZ));
+}
+
+void Renderer::DispatchInvocations(const Shader& shader, unsigned int countX, unsigned int countY, unsigned int countZ) const
+{
+	// Rounds up to whole work groups; the shader has to bounds check the rest.
+	const int* size = shader.GetWorkGroupSize();
+	if (size[0] == 0)
+		return; // Not linked yet.
+	Dispatch(shader, (countX + size[0] - 1) / size[0], (countY + size[1] - 1) / size[1], (countZ + size[2] - 1) / size[2]);
+}
+
+void Renderer::Barrier(unsigned int barriers) const
+{
+	GLCall(glMemoryBarrier(barriers));
+}
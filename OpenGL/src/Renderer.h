@@ -1,8 +1,12 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <vector>
+
+#include "Framebuffer.h"
 #include "VertexArray.h"
 #include "IndexBuffer.h"
+#include "Scene.h"
 #include "Shader.h"
 
 #define ASSERT(x) if (!(x)) __debugbreak();
@@ -16,7 +20,32 @@ bool GLLogCall(const char* function, const char* file, int line);
 
 class Renderer
 {
+private:
+	const Framebuffer* m_Target;
+	int m_WindowViewport[4];
+	mutable std::vector<Mat4> m_MVPs; // Scratch for Submit
 public:
+	Renderer();
+
+	// Where Clear and Draw go; nullptr (the default) is the window. Also sets the
+	// viewport to the framebuffer, and back to the window's when switching back.
+	void SetTarget(const Framebuffer* framebuffer);
+	inline const Framebuffer* GetTarget() const { return m_Target; }
+
+	// Clears the color of the window, or every attachment of a framebuffer.
 	void Clear() const;
 	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+	// Draws every renderable entity whose world bounds are in the view
+	// frustum, with viewProjection * world in u_MVP. Call
+	// Scene::UpdateTransforms first. Returns the number of draws.
+	unsigned int Submit(const Scene& scene, const Mat4& viewProjection) const;
+
+	// Compute (GL 4.3 or ARB_compute_shader). Dispatch counts work groups, not
+	// invocations; call Barrier with the bits matching how the results are read
+	// next (GL_SHADER_STORAGE_BARRIER_BIT, GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT, ...).
+	void Dispatch(const Shader& shader, unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1) const;
+	void DispatchInvocations(const Shader& shader, unsigned int countX, unsigned int countY = 1, unsigned int countZ = 1) const;
+	void Barrier(unsigned int barriers = GL_ALL_BARRIER_BITS) const;
+
+	static bool IsComputeSupported();
 };
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "Sampler.h"
+#include "Renderer.h"
+
+std::vector<std::weak_ptr<Sampler>> SamplerCache::s_Samplers;
+
+SamplerState SamplerState::Default()
+{
+	return { GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, 16.0f };
+}
+
+bool SamplerState::operator==(const SamplerState& other) const
+{
+	return MinFilter == other.MinFilter && MagFilter == other.MagFilter
+		&& WrapS == other.WrapS && WrapT == other.WrapT && Anisotropy == other.Anisotropy;
+}
+
+Sampler::Sampler(const SamplerState& state)
+	: m_State(state)
+{
+	GLCall(glGenSamplers(1, &m_RendererID));
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, state.MinFilter));
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, state.MagFilter));
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_WRAP_S, state.WrapS));
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_WRAP_T, state.WrapT));
+
+	float anisotropy = state.Anisotropy < GetMaxAnisotropy() ? state.Anisotropy : GetMaxAnisotropy();
+	if (anisotropy > 1.0f)
+	{
+		GLCall(glSamplerParameterf(m_RendererID, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy));
+	}
+}
+
+Sampler::~Sampler()
+{
+	GLCall(glDeleteSamplers(1, &m_RendererID));
+}
+
+void Sampler::Bind(unsigned int slot) const
+{
+	GLCall(glBindSampler(slot, m_RendererID));
+}
+
+void Sampler::Unbind(unsigned int slot)
+{
+	GLCall(glBindSampler(slot, 0));
+}
+
+float Sampler::GetMaxAnisotropy()
+{
+	if (!GLEW_EXT_texture_filter_anisotropic && !GLEW_ARB_texture_filter_anisotropic)
+		return 1.0f;
+
+	static float s_MaxAnisotropy = 0.0f;
+	if (s_MaxAnisotropy == 0.0f)
+	{
+		GLCall(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &s_MaxAnisotropy));
+	}
+	return s_MaxAnisotropy;
+}
+
+std::shared_ptr<Sampler> SamplerCache::Get(const SamplerState& state)
+{
+	for (unsigned int i = 0; i < s_Samplers.size();)
+	{
+		std::shared_ptr<Sampler> sampler = s_Samplers[i].lock();
+		if (!sampler)
+		{
+			s_Samplers[i] = s_Samplers.back();
+			s_Samplers.pop_back();
+			continue;
+		}
+		if (sampler->GetState() == state)
+			return sampler;
+		i++;
+	}
+
+	std::shared_ptr<Sampler> sampler = std::make_shared<Sampler>(state);
+	s_Samplers.push_back(sampler);
+	return sampler;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+struct SamplerState
+{
+	unsigned int MinFilter;
+	unsigned int MagFilter;
+	unsigned int WrapS;
+	unsigned int WrapT;
+	float Anisotropy; // 1 turns it off, clamped to what the driver supports
+
+	// Trilinear, clamped to edge, with the highest anisotropy available.
+	static SamplerState Default();
+
+	bool operator==(const SamplerState& other) const;
+};
+
+// GL sampler object. Filtering and wrapping live here instead of in each
+// texture, so textures that sample the same way share one object.
+class Sampler
+{
+private:
+	unsigned int m_RendererID;
+	SamplerState m_State;
+public:
+	Sampler(const SamplerState& state);
+	~Sampler();
+
+	void Bind(unsigned int slot) const;
+	static void Unbind(unsigned int slot);
+
+	inline const SamplerState& GetState() const { return m_State; }
+
+	static float GetMaxAnisotropy();
+};
+
+// Hands out one Sampler per distinct state. Only weak references are kept, so
+// a sampler is deleted together with the last texture using it (and never
+// after the GL context is gone).
+class SamplerCache
+{
+private:
+	static std::vector<std::weak_ptr<Sampler>> s_Samplers;
+public:
+	static std::shared_ptr<Sampler> Get(const SamplerState& state);
+};
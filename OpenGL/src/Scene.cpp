@@ -0,0 +1,144 @@
+#include "Scene.h"
+
+#include <algorithm>
+
+#include "JobSystem.h"
+
+template<typename T>
+static void InsertAt(std::vector<T>& values, unsigned int index, const T& value)
+{
+	values.insert(values.begin() + index, value);
+}
+
+// Keeps the entries whose remap is not NoEntity, in order.
+template<typename T>
+static void Compact(std::vector<T>& values, const std::vector<unsigned int>& remap)
+{
+	unsigned int kept = 0;
+	for (unsigned int i = 0; i < values.size(); i++)
+	{
+		if (remap[i] != NoEntity)
+			values[kept++] = values[i];
+	}
+	values.resize(kept);
+}
+
+Entity Scene::Create(Entity parent)
+{
+	unsigned int parentIndex = NoEntity;
+	unsigned int level = 0;
+	if (parent != NoEntity)
+	{
+		parentIndex = m_Indices[parent];
+		level = (unsigned int)(std::upper_bound(m_LevelEnds.begin(), m_LevelEnds.end(), parentIndex) - m_LevelEnds.begin()) + 1;
+	}
+	if (level == m_LevelEnds.size())
+		m_LevelEnds.push_back(GetCount());
+
+	// Last of its level: only deeper entities move.
+	unsigned int index = m_LevelEnds[level];
+	for (unsigned int i = level; i < m_LevelEnds.size(); i++)
+		m_LevelEnds[i]++;
+	for (unsigned int& p : m_Parents)
+	{
+		if (p != NoEntity && p >= index)
+			p++;
+	}
+
+	Entity entity;
+	if (!m_FreeEntities.empty())
+	{
+		entity = m_FreeEntities.back();
+		m_FreeEntities.pop_back();
+	}
+	else
+	{
+		entity = (Entity)m_Indices.size();
+		m_Indices.push_back(NoEntity);
+	}
+
+	InsertAt(m_Entities, index, entity);
+	InsertAt(m_Parents, index, parentIndex);
+	InsertAt(m_Positions, index, Vec3{ 0.0f, 0.0f, 0.0f });
+	InsertAt(m_Rotations, index, Quat::Identity());
+	InsertAt(m_Scales, index, Vec3{ 1.0f, 1.0f, 1.0f });
+	InsertAt(m_WorldMatrices, index, Mat4::Identity());
+	InsertAt(m_LocalBounds, index, AABB::Empty());
+	InsertAt(m_WorldBounds, index, AABB::Empty());
+	InsertAt(m_Renderables, index, RenderComponent());
+
+	for (unsigned int i = index; i < m_Entities.size(); i++)
+		m_Indices[m_Entities[i]] = i;
+	return entity;
+}
+
+void Scene::Destroy(Entity entity)
+{
+	if (!IsValid(entity))
+		return;
+
+	// Children come after their parents, so one pass finds the whole subtree.
+	std::vector<unsigned int> remap(GetCount());
+	unsigned int first = m_Indices[entity], kept = 0;
+	for (unsigned int i = 0; i < GetCount(); i++)
+	{
+		bool removed = i == first || (m_Parents[i] != NoEntity && remap[m_Parents[i]] == NoEntity);
+		remap[i] = removed ? NoEntity : kept++;
+	}
+
+	// Levels can only empty out from the deepest one up.
+	for (unsigned int& level : m_LevelEnds)
+		level = (unsigned int)std::count_if(remap.begin(), remap.begin() + level, [](unsigned int r) { return r != NoEntity; });
+	while (!m_LevelEnds.empty() && m_LevelEnds.back() == (m_LevelEnds.size() > 1 ? m_LevelEnds[m_LevelEnds.size() - 2] : 0))
+		m_LevelEnds.pop_back();
+
+	for (unsigned int i = 0; i < GetCount(); i++)
+	{
+		if (remap[i] == NoEntity)
+		{
+			m_Indices[m_Entities[i]] = NoEntity;
+			m_FreeEntities.push_back(m_Entities[i]);
+		}
+		else if (m_Parents[i] != NoEntity)
+		{
+			m_Parents[i] = remap[m_Parents[i]];
+		}
+	}
+
+	Compact(m_Entities, remap);
+	Compact(m_Parents, remap);
+	Compact(m_Positions, remap);
+	Compact(m_Rotations, remap);
+	Compact(m_Scales, remap);
+	Compact(m_WorldMatrices, remap);
+	Compact(m_LocalBounds, remap);
+	Compact(m_WorldBounds, remap);
+	Compact(m_Renderables, remap);
+
+	for (unsigned int i = 0; i < m_Entities.size(); i++)
+		m_Indices[m_Entities[i]] = i;
+}
+
+void Scene::UpdateTransforms(JobSystem* jobs)
+{
+	// A level only reads the one before it, which is already done.
+	unsigned int begin = 0;
+	for (unsigned int end : m_LevelEnds)
+	{
+		if (jobs && end - begin >= ParallelThreshold)
+			jobs->ParallelFor(end - begin, 1024, [this, begin](unsigned int first, unsigned int last) { UpdateRange(begin + first, begin + last); });
+		else
+			UpdateRange(begin, end);
+		begin = end;
+	}
+}
+
+void Scene::UpdateRange(unsigned int begin, unsigned int end)
+{
+	for (unsigned int i = begin; i < end; i++)
+	{
+		Mat4 local = Mat4::FromTRS(m_Positions[i], m_Rotations[i], m_Scales[i]);
+		m_WorldMatrices[i] = m_Parents[i] == NoEntity ? local : m_WorldMatrices[m_Parents[i]] * local;
+		m_WorldBounds[i] = Transform(m_WorldMatrices[i], m_LocalBounds[i]);
+	}
+}
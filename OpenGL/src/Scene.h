@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+#include "Math.h"
+
+class IndexBuffer;
+class JobSystem;
+class Shader;
+class Texture;
+class VertexArray;
+
+typedef unsigned int Entity;
+static const Entity NoEntity = ~0u;
+
+// What Renderer::Submit draws for an entity. Entities without a VertexArray
+// only take part in the hierarchy.
+struct RenderComponent
+{
+	const VertexArray* Vertices;
+	const IndexBuffer* Indices;
+	Shader* Material;      // Gets its model-view-projection matrix as u_MVP
+	const Texture* Albedo; // Bound to slot 0, may be null
+
+	RenderComponent() : Vertices(nullptr), Indices(nullptr), Material(nullptr), Albedo(nullptr) {}
+};
+
+// Entities and their components in structure-of-arrays form. Every component
+// has its own densely packed array, ordered by depth in the hierarchy, so
+// parents always come before their children and UpdateTransforms is a single
+// forward sweep; each depth level can be split across threads.
+//
+// Entity handles stay valid until destroyed; Create and Destroy move the
+// arrays around and are meant for loading, not for every frame.
+class Scene
+{
+private:
+	// Dense arrays, one entry per entity.
+	std::vector<Entity> m_Entities;
+	std::vector<unsigned int> m_Parents; // Dense index, NoEntity for roots
+	std::vector<Vec3> m_Positions;
+	std::vector<Quat> m_Rotations;
+	std::vector<Vec3> m_Scales;
+	std::vector<Mat4> m_WorldMatrices;
+	std::vector<AABB> m_LocalBounds;
+	std::vector<AABB> m_WorldBounds;
+	std::vector<RenderComponent> m_Renderables;
+
+	std::vector<unsigned int> m_LevelEnds; // Dense index past each depth level
+	std::vector<unsigned int> m_Indices;   // Entity to dense index, NoEntity when free
+	std::vector<Entity> m_FreeEntities;
+public:
+	Entity Create(Entity parent = NoEntity);
+	// Destroys the children too.
+	void Destroy(Entity entity);
+	inline bool IsValid(Entity entity) const { return entity < m_Indices.size() && m_Indices[entity] != NoEntity; }
+	inline unsigned int GetCount() const { return (unsigned int)m_Entities.size(); }
+
+	// Relative to the parent.
+	inline void SetPosition(Entity entity, const Vec3& position) { m_Positions[m_Indices[entity]] = position; }
+	inline void SetRotation(Entity entity, const Quat& rotation) { m_Rotations[m_Indices[entity]] = rotation; }
+	inline void SetScale(Entity entity, const Vec3& scale) { m_Scales[m_Indices[entity]] = scale; }
+	inline const Vec3& GetPosition(Entity entity) const { return m_Positions[m_Indices[entity]]; }
+	inline const Quat& GetRotation(Entity entity) const { return m_Rotations[m_Indices[entity]]; }
+	inline const Vec3& GetScale(Entity entity) const { return m_Scales[m_Indices[entity]]; }
+
+	// In the entity's own space; the world box follows the transform.
+	inline void SetBounds(Entity entity, const AABB& bounds) { m_LocalBounds[m_Indices[entity]] = bounds; }
+	inline void SetRenderable(Entity entity, const RenderComponent& renderable) { m_Renderables[m_Indices[entity]] = renderable; }
+
+	// Valid after UpdateTransforms.
+	inline const Mat4& GetWorldMatrix(Entity entity) const { return m_WorldMatrices[m_Indices[entity]]; }
+	inline const AABB& GetWorldBounds(Entity entity) const { return m_WorldBounds[m_Indices[entity]]; }
+
+	// Recomputes every world matrix and box, level by level. Large levels
+	// are split over the job system when one is given.
+	void UpdateTransforms(JobSystem* jobs = nullptr);
+
+	// Dense arrays for systems that sweep the whole scene, indexed alike.
+	inline const std::vector<RenderComponent>& GetRenderables() const { return m_Renderables; }
+	inline const std::vector<Mat4>& GetWorldMatrices() const { return m_WorldMatrices; }
+	inline const std::vector<AABB>& GetWorldBounds() const { return m_WorldBounds; }
+
+	// Levels smaller than this are swept on the calling thread.
+	static const unsigned int ParallelThreshold = 4096;
+private:
+	void UpdateRange(unsigned int begin, unsigned int end);
+};
@@ -1,18 +1,27 @@
 #include "Shader.h"
 
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
 
 #include "Renderer.h"
+#include "VertexBufferLayout.h"
 
+UniformStats Shader::s_UniformStats = { 0, 0 };
 
 Shader::Shader(const std::string& filepath)
-	: m_FilePath(filepath), m_RendererID(0)
+	: m_FilePath(filepath), m_RendererID(0), m_IsCompute(false), m_WorkGroupSize{ 0, 0, 0 }, m_LinkCount(0)
 {
 	ShaderProgramSource source = ParseShader(filepath);
-	m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+	m_IsCompute = !source.ComputeSource.empty();
+	SetProgram(FinishProgram(SubmitProgram(source)));
+}
+
+Shader::Shader()
+	: m_RendererID(0), m_IsCompute(false), m_WorkGroupSize{ 0, 0, 0 }, m_LinkCount(0)
+{
 }
 
 Shader::~Shader()
@@ -20,18 +29,33 @@ Shader::~Shader()
 	GLCall(glDeleteProgram(m_RendererID));
 }
 
-ShaderProgramSource Shader::ParseShader(const std::string& filepath)
+enum class ShaderType
 {
-	std::ifstream stream(filepath);
+	NONE = -1, VERTEX = 0, FRAGMENT = 1, COMPUTE = 2
+};
+
+static const unsigned int s_StageTypes[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_COMPUTE_SHADER };
+static const char* s_StageNames[] = { "vertex", "fragment", "compute" };
 
-	enum class ShaderType
+static bool ReadShaderFile(const std::string& filepath, std::stringstream ss[], ShaderType& type,
+	std::vector<std::string>& includes, int depth)
+{
+	std::ifstream stream(filepath);
+	if (!stream)
+	{
+		std::cout << "Failed to open shader '" << filepath << "'" << std::endl;
+		return false;
+	}
+	if (depth > 16)
 	{
-		NONE = -1, VERTEX = 0, FRAGMENT = 1
-	};
+		std::cout << "Shader '" << filepath << "' has too many nested #include" << std::endl;
+		return false;
+	}
+
+	size_t slash = filepath.find_last_of("/\\");
+	std::string directory = slash == std::string::npos ? "" : filepath.substr(0, slash + 1);
 
 	std::string line;
-	std::stringstream ss[2];
-	ShaderType type = ShaderType::NONE;
 	while (getline(stream, line))
 	{
 		if (line.find("#shader") != std::string::npos)
@@ -40,13 +64,61 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
 				type = ShaderType::VERTEX;
 			else if (line.find("fragment") != std::string::npos)
 				type = ShaderType::FRAGMENT;
+			else if (line.find("compute") != std::string::npos)
+				type = ShaderType::COMPUTE;
 		}
-		else
+		else if (line.find("#include") != std::string::npos)
+		{
+			size_t first = line.find('"');
+			size_t last = line.find('"', first + 1);
+			if (first == std::string::npos || last == std::string::npos)
+			{
+				std::cout << "Bad #include in '" << filepath << "': " << line << std::endl;
+				return false;
+			}
+			std::string include = directory + line.substr(first + 1, last - first - 1);
+			includes.push_back(include);
+			if (!ReadShaderFile(include, ss, type, includes, depth + 1))
+				return false;
+		}
+		else if (type != ShaderType::NONE)
 		{
 			ss[(int)type] << line << '\n';
 		}
 	}
-	return { ss[0].str(), ss[1].str() };
+	return true;
+}
+
+static std::string AddDefines(const std::string& source, const std::vector<std::string>& defines)
+{
+	if (defines.empty())
+		return source;
+
+	std::string block;
+	for (const std::string& define : defines)
+		block += "#define " + define + " 1\n";
+
+	// #version must stay the first line of the stage.
+	size_t version = source.find("#version");
+	if (version == std::string::npos)
+		return block + source;
+	size_t lineEnd = source.find('\n', version);
+	if (lineEnd == std::string::npos)
+		return source + '\n' + block;
+	return source.substr(0, lineEnd + 1) + block + source.substr(lineEnd + 1);
+}
+
+ShaderProgramSource Shader::ParseShader(const std::string& filepath, const std::vector<std::string>& defines)
+{
+	std::stringstream ss[3];
+	ShaderType type = ShaderType::NONE;
+	ShaderProgramSource source;
+	ReadShaderFile(filepath, ss, type, source.Includes, 0);
+
+	source.VertexSource = AddDefines(ss[0].str(), defines);
+	source.FragmentSource = AddDefines(ss[1].str(), defines);
+	source.ComputeSource = AddDefines(ss[2].str(), defines);
+	return source;
 }
 
 unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
@@ -56,39 +128,106 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 	glShaderSource(id, 1, &src, nullptr);
 	glCompileShader(id);
 
+	// Status is only queried in FinishProgram, after the link. Asking here would
+	// force the driver to finish this shader before starting the next one.
+	return id;
+}
+
+Shader::PendingProgram Shader::SubmitProgram(const ShaderProgramSource& source, bool retrievable)
+{
+	PendingProgram pending;
+	pending.Program = glCreateProgram();
+	if (retrievable)
+		glProgramParameteri(pending.Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+	const std::string* sources[] = { &source.VertexSource, &source.FragmentSource, &source.ComputeSource };
+	bool isCompute = !source.ComputeSource.empty();
+	for (int stage = 0; stage < 3; stage++)
+	{
+		pending.Stages[stage] = 0;
+		if ((stage == (int)ShaderType::COMPUTE) != isCompute)
+			continue;
+
+		pending.Stages[stage] = CompileShader(s_StageTypes[stage], *sources[stage]);
+		glAttachShader(pending.Program, pending.Stages[stage]);
+	}
+	glLinkProgram(pending.Program);
+
+	return pending;
+}
+
+bool Shader::IsProgramComplete(const PendingProgram& pending)
+{
+	// Without KHR/ARB_parallel_shader_compile there is no way to ask without
+	// blocking, so the program is reported as complete and FinishProgram waits.
+	if (!GLEW_KHR_parallel_shader_compile && !GLEW_ARB_parallel_shader_compile)
+		return true;
+
+	int completed = GL_FALSE;
+	glGetProgramiv(pending.Program, GL_COMPLETION_STATUS_KHR, &completed);
+	return completed == GL_TRUE;
+}
+
+unsigned int Shader::FinishProgram(const PendingProgram& pending)
+{
 	// ERROR HANDLING
 	int result;
-	glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+	glGetProgramiv(pending.Program, GL_LINK_STATUS, &result);
 	if (result == GL_FALSE)
 	{
+		for (int stage = 0; stage < 3; stage++)
+		{
+			unsigned int id = pending.Stages[stage];
+			if (id == 0)
+				continue;
+
+			glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+			if (result == GL_TRUE)
+				continue;
+
+			int length;
+			glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+			char* message = (char*)alloca(length * sizeof(char));
+			glGetShaderInfoLog(id, length, &length, message);
+			std::cout << "Failed to compile " << s_StageNames[stage] << std::endl;
+			std::cout << message << std::endl;
+		}
+
 		int length;
-		glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-		char* message = (char*)alloca(length * sizeof(char));
-		glGetShaderInfoLog(id, length, &length, message);
-		std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << std::endl;
-		std::cout << message << std::endl;
-		glDeleteShader(id);
+		glGetProgramiv(pending.Program, GL_INFO_LOG_LENGTH, &length);
+		if (length > 0)
+		{
+			char* message = (char*)alloca(length * sizeof(char));
+			glGetProgramInfoLog(pending.Program, length, &length, message);
+			std::cout << "Failed to link program" << std::endl;
+			std::cout << message << std::endl;
+		}
+
+		DeleteProgram(pending);
 		return 0;
 	}
 
-	return id;
-}
-
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
-{
-	unsigned int program = glCreateProgram();
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+	glValidateProgram(pending.Program);
 
-	glAttachShader(program, vs);
-	glAttachShader(program, fs);
-	glLinkProgram(program);
-	glValidateProgram(program);
+	for (unsigned int id : pending.Stages)
+	{
+		if (id == 0)
+			continue;
+		glDetachShader(pending.Program, id);
+		glDeleteShader(id);
+	}
 
-	glDeleteShader(vs);
-	glDeleteShader(fs);
+	return pending.Program;
+}
 
-	return program;
+void Shader::DeleteProgram(const PendingProgram& pending)
+{
+	for (unsigned int id : pending.Stages)
+	{
+		if (id != 0)
+			glDeleteShader(id);
+	}
+	glDeleteProgram(pending.Program);
 }
 
 
@@ -103,31 +242,354 @@ void Shader::Unbind() const
 	GLCall(glUseProgram(0));
 }
 
-void Shader::SetUniform1i(const std::string& name, int value)
+void Shader::SetProgram(unsigned int program)
 {
-	GLCall(glUniform1i(GetUniformLocation(name), value));
+	if (m_RendererID != 0)
+	{
+		GLCall(glDeleteProgram(m_RendererID));
+	}
+	m_RendererID = program;
+	if (m_RendererID != 0)
+	{
+		m_LinkCount++;
+		Reflect();
+		RestoreUniformValues();
+		for (const auto& layout : m_Layouts)
+			ValidateLayout(*layout);
+	}
 }
 
-void Shader::SetUniform1f(const std::string& name, float value)
+void Shader::Reflect()
 {
-	GLCall(glUniform1f(GetUniformLocation(name), value));
+	// Handles already given out keep their slot, only the locations change.
+	for (ShaderUniform& uniform : m_Uniforms)
+		uniform.Location = -1;
+	m_Attributes.clear();
+	m_UniformBlocks.clear();
+
+	// A failed link leaves no program, and querying program 0 raises
+	// GL_INVALID_VALUE. The tables stay empty instead.
+	if (m_RendererID == 0)
+		return;
+
+	if (m_IsCompute)
+	{
+		GLCall(glGetProgramiv(m_RendererID, GL_COMPUTE_WORK_GROUP_SIZE, m_WorkGroupSize));
+	}
+
+	int count = 0, maxLength = 0;
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_ATTRIBUTES, &count));
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength));
+	std::vector<char> name(maxLength > 0 ? maxLength : 1);
+	for (int i = 0; i < count; i++)
+	{
+		ShaderAttribute attribute;
+		int length = 0;
+		GLCall(glGetActiveAttrib(m_RendererID, i, (int)name.size(), &length, &attribute.Size, &attribute.Type, name.data()));
+		attribute.Name = name.data();
+		GLCall(attribute.Location = glGetAttribLocation(m_RendererID, name.data()));
+		if (attribute.Location != -1) // Skips gl_VertexID and friends.
+			m_Attributes.push_back(attribute);
+	}
+
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCKS, &count));
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength));
+	name.resize(maxLength > 0 ? maxLength : 1);
+	for (int i = 0; i < count; i++)
+	{
+		ShaderUniformBlock block;
+		GLCall(glGetActiveUniformBlockName(m_RendererID, i, (int)name.size(), nullptr, name.data()));
+		block.Name = name.data();
+		block.Index = i;
+		GLCall(glGetActiveUniformBlockiv(m_RendererID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.DataSize));
+		m_UniformBlocks.push_back(block);
+	}
+
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+	name.resize(maxLength > 0 ? maxLength : 1);
+	for (int i = 0; i < count; i++)
+	{
+		ShaderUniform uniform;
+		int length = 0;
+		GLCall(glGetActiveUniform(m_RendererID, i, (int)name.size(), &length, &uniform.Size, &uniform.Type, name.data()));
+
+		// Arrays are reported as "name[0]", look them up by their plain name.
+		if (length > 3 && strcmp(&name[length - 3], "[0]") == 0)
+			name[length - 3] = '\0';
+		uniform.Name = name.data();
+
+		unsigned int index = i;
+		GLCall(glGetActiveUniformsiv(m_RendererID, 1, &index, GL_UNIFORM_BLOCK_INDEX, &uniform.BlockIndex));
+		GLCall(glGetActiveUniformsiv(m_RendererID, 1, &index, GL_UNIFORM_OFFSET, &uniform.Offset));
+		GLCall(glGetActiveUniformsiv(m_RendererID, 1, &index, GL_UNIFORM_ARRAY_STRIDE, &uniform.ArrayStride));
+		GLCall(glGetActiveUniformsiv(m_RendererID, 1, &index, GL_UNIFORM_MATRIX_STRIDE, &uniform.MatrixStride));
+
+		if (uniform.BlockIndex >= 0)
+		{
+			uniform.Location = -1;
+			m_UniformBlocks[uniform.BlockIndex].Members.push_back(uniform);
+			continue;
+		}
+
+		GLCall(uniform.Location = glGetUniformLocation(m_RendererID, name.data()));
+		int slot = FindUniform(uniform.Name.c_str());
+		if (slot == -1)
+			AddUniform(uniform);
+		else
+			m_Uniforms[slot] = uniform;
+	}
 }
 
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+int Shader::FindUniform(const char* name) const
 {
-	GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+	// A short linear search beats hashing for the few uniforms a shader has.
+	for (unsigned int i = 0; i < m_Uniforms.size(); i++)
+	{
+		if (m_Uniforms[i].Name == name)
+			return i;
+	}
+	return -1;
 }
 
-
-int Shader::GetUniformLocation(const std::string& name)
+UniformHandle Shader::GetUniformHandle(const char* name)
 {
-	// Checa o cache e retorna se for encontrado.
-	if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-		return m_UniformLocationCache[name];
-	// Traz um novo se nao encontrar no cache.
-	GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
-	if (location == -1)
+	int slot = FindUniform(name);
+	if (slot != -1)
+		return UniformHandle(slot);
+
+	// Unknown names still get a slot so the warning is printed only once and a
+	// later reload that adds the uniform can fill in its location.
+	if (m_RendererID != 0)
 		std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
-	m_UniformLocationCache[name] = location;
-	return location;
+	return AddUniform({ name, -1, 0, 0, -1, -1, -1, -1 });
+}
+
+UniformHandle Shader::AddUniform(const ShaderUniform& uniform)
+{
+	UniformValue value;
+	value.ComponentType = 0;
+	value.Count = 0;
+	m_Uniforms.push_back(uniform);
+	m_UniformValues.push_back(value);
+	return UniformHandle((int)m_Uniforms.size() - 1);
+}
+
+bool Shader::UpdateUniformValue(UniformHandle handle, unsigned int componentType, const void* data, unsigned int count)
+{
+	// The program keeps its uniform values, so a set that changes nothing is
+	// just driver overhead.
+	UniformValue& value = m_UniformValues[handle.Index];
+	if (value.ComponentType == componentType && value.Count == count && memcmp(value.Floats, data, count * 4) == 0)
+	{
+		s_UniformStats.Skipped++;
+		return false;
+	}
+
+	value.ComponentType = componentType;
+	value.Count = count;
+	memcpy(value.Floats, data, count * 4);
+	if (m_Uniforms[handle.Index].Location == -1)
+		return false; // Kept in case a reload adds the uniform.
+
+	s_UniformStats.Set++;
+	return true;
+}
+
+void Shader::RestoreUniformValues()
+{
+	// A reloaded program starts with every uniform at zero.
+	int previous = 0;
+	bool bound = false;
+	for (unsigned int i = 0; i < m_Uniforms.size(); i++)
+	{
+		const UniformValue& value = m_UniformValues[i];
+		int location = m_Uniforms[i].Location;
+		if (value.Count == 0 || location == -1)
+			continue;
+
+		if (!bound)
+		{
+			GLCall(glGetIntegerv(GL_CURRENT_PROGRAM, &previous));
+			GLCall(glUseProgram(m_RendererID));
+			bound = true;
+		}
+
+		if (value.ComponentType == GL_INT)
+		{
+			switch (value.Count)
+			{
+				case 1: GLCall(glUniform1iv(location, 1, value.Ints)); break;
+				case 4: GLCall(glUniform4iv(location, 1, value.Ints)); break;
+			}
+		}
+		else
+		{
+			switch (value.Count)
+			{
+				case 1: GLCall(glUniform1fv(location, 1, value.Floats)); break;
+				case 4: GLCall(glUniform4fv(location, 1, value.Floats)); break;
+				case 16: GLCall(glUniformMatrix4fv(location, 1, GL_FALSE, value.Floats)); break;
+			}
+		}
+	}
+
+	if (bound)
+	{
+		GLCall(glUseProgram(previous));
+	}
+}
+
+const ShaderUniformBlock* Shader::GetUniformBlock(const char* name) const
+{
+	for (const ShaderUniformBlock& block : m_UniformBlocks)
+	{
+		if (block.Name == name)
+			return &block;
+	}
+	return nullptr;
+}
+
+void Shader::SetUniformBlockBinding(const char* name, unsigned int binding)
+{
+	const ShaderUniformBlock* block = GetUniformBlock(name);
+	if (!block)
+	{
+		std::cout << "Warning: uniform block '" << name << "' doesn't exist!" << std::endl;
+		return;
+	}
+	GLCall(glUniformBlockBinding(m_RendererID, block->Index, binding));
+}
+
+bool Shader::ValidateLayout(const VertexBufferLayout& layout) const
+{
+	// VertexArray::AddBuffer feeds element i to attribute location i.
+	const auto& elements = layout.GetElements();
+	bool valid = true;
+	for (const ShaderAttribute& attribute : m_Attributes)
+	{
+		unsigned int componentType = ShaderReflection::GetComponentType(attribute.Type);
+		unsigned int components = ShaderReflection::GetComponentCount(attribute.Type);
+		if (attribute.Location >= (int)elements.size())
+		{
+			std::cout << "Warning: " << m_FilePath << ": attribute '" << attribute.Name << "' (location "
+				<< attribute.Location << ") is not in the vertex layout" << std::endl;
+			valid = false;
+			continue;
+		}
+
+		const VertexBufferElement& element = elements[attribute.Location];
+		if (element.count > components)
+		{
+			std::cout << "Warning: " << m_FilePath << ": attribute '" << attribute.Name << "' is "
+				<< ShaderReflection::GetTypeName(attribute.Type) << " but the layout gives it "
+				<< element.count << " components" << std::endl;
+			valid = false;
+		}
+		// glVertexAttribPointer always delivers floats, integer inputs would read garbage.
+		if (componentType != GL_FLOAT)
+		{
+			std::cout << "Warning: " << m_FilePath << ": attribute '" << attribute.Name << "' is "
+				<< ShaderReflection::GetTypeName(attribute.Type) << " but is fed as float" << std::endl;
+			valid = false;
+		}
+	}
+	return valid;
+}
+
+void Shader::AddLayout(const VertexBufferLayout& layout)
+{
+	m_Layouts.emplace_back(new VertexBufferLayout(layout));
+	if (IsReady())
+		ValidateLayout(layout);
+}
+
+bool Shader::CheckUniformType(UniformHandle handle, unsigned int componentType, unsigned int count) const
+{
+	ASSERT(handle.IsValid());
+	const ShaderUniform& uniform = m_Uniforms[handle.Index];
+	if (uniform.Location == -1)
+		return true; // Setting a missing uniform is a no-op.
+
+	// Samplers and bools are set with the int setters, bools with float ones too.
+	unsigned int type = ShaderReflection::GetComponentType(uniform.Type);
+	bool typeMatches = type == componentType || (type == GL_BOOL && componentType != GL_DOUBLE);
+	return typeMatches && ShaderReflection::GetComponentCount(uniform.Type) == count;
+}
+
+void Shader::SetUniform1i(UniformHandle handle, int value)
+{
+	ASSERT(CheckUniformType(handle, GL_INT, 1));
+	if (UpdateUniformValue(handle, GL_INT, &value, 1))
+	{
+		GLCall(glUniform1i(m_Uniforms[handle.Index].Location, value));
+	}
+}
+
+void Shader::SetUniform1f(UniformHandle handle, float value)
+{
+	ASSERT(CheckUniformType(handle, GL_FLOAT, 1));
+	if (UpdateUniformValue(handle, GL_FLOAT, &value, 1))
+	{
+		GLCall(glUniform1f(m_Uniforms[handle.Index].Location, value));
+	}
+}
+
+void Shader::SetUniform4f(UniformHandle handle, float v0, float v1, float v2, float v3)
+{
+	ASSERT(CheckUniformType(handle, GL_FLOAT, 4));
+	const float values[] = { v0, v1, v2, v3 };
+	if (UpdateUniformValue(handle, GL_FLOAT, values, 4))
+	{
+		GLCall(glUniform4f(m_Uniforms[handle.Index].Location, v0, v1, v2, v3));
+	}
+}
+
+void Shader::SetUniformMat4f(UniformHandle handle, const float* matrix)
+{
+	ASSERT(CheckUniformType(handle, GL_FLOAT, 16));
+	if (UpdateUniformValue(handle, GL_FLOAT, matrix, 16))
+	{
+		GLCall(glUniformMatrix4fv(m_Uniforms[handle.Index].Location, 1, GL_FALSE, matrix));
+	}
+}
+
+void Shader::SetUniformMat4fv(UniformHandle handle, const float* matrices, unsigned int count)
+{
+	ASSERT(CheckUniformType(handle, GL_FLOAT, 16));
+	const ShaderUniform& uniform = m_Uniforms[handle.Index];
+	ASSERT(uniform.Location == -1 || count <= (unsigned int)uniform.Size);
+	if (count == 1)
+	{
+		SetUniformMat4f(handle, matrices);
+		return;
+	}
+
+	// The cache only holds element 0, which this may have changed.
+	m_UniformValues[handle.Index].Count = 0;
+	if (uniform.Location == -1 || count == 0)
+		return;
+
+	s_UniformStats.Set++;
+	GLCall(glUniformMatrix4fv(uniform.Location, count, GL_FALSE, matrices));
+}
+
+void Shader::SetUniform1i(const char* name, int value)
+{
+	SetUniform1i(GetUniformHandle(name), value);
+}
+
+void Shader::SetUniform1f(const char* name, float value)
+{
+	SetUniform1f(GetUniformHandle(name), value);
+}
+
+void Shader::SetUniform4f(const char* name, float v0, float v1, float v2, float v3)
+{
+	SetUniform4f(GetUniformHandle(name), v0, v1, v2, v3);
+}
+
+void Shader::SetUniformMat4f(const char* name, const float* matrix)
+{
+	SetUniformMat4f(GetUniformHandle(name), matrix);
 }
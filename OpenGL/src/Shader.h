@@ -1,37 +1,150 @@
 #pragma once
 
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
+
+#include "ShaderReflection.h"
+
+class VertexBufferLayout;
 
 struct ShaderProgramSource
 {
 	std::string VertexSource;
 	std::string FragmentSource;
+	std::string ComputeSource; // When set, the program is compute only
+	std::vector<std::string> Includes; // Files pulled in with #include
+};
+
+// Index into a Shader's uniform table. Resolve it once with GetUniformHandle and
+// keep it: it stays valid when the program is reloaded.
+struct UniformHandle
+{
+	int Index;
+
+	UniformHandle() : Index(-1) {}
+	explicit UniformHandle(int index) : Index(index) {}
+
+	inline bool IsValid() const { return Index >= 0; }
+};
+
+// Last value set through a Shader. Lets it skip glUniform calls that would not
+// change anything and restore the values after a hot reload.
+struct UniformValue
+{
+	unsigned int ComponentType; // GL_FLOAT or GL_INT
+	unsigned int Count;         // 0 until the uniform is first set
+	union
+	{
+		float Floats[16];
+		int Ints[16];
+	};
+};
+
+struct UniformStats
+{
+	unsigned int Set;
+	unsigned int Skipped;
 };
 
 class Shader
 {
 private:
 	std::string m_FilePath;
+	std::vector<std::string> m_Defines;
+	std::vector<std::string> m_Includes;
 	unsigned int m_RendererID;
-	std::unordered_map<std::string, int> m_UniformLocationCache;
+	bool m_IsCompute;
+	int m_WorkGroupSize[3];
+	std::vector<ShaderUniform> m_Uniforms;
+	std::vector<UniformValue> m_UniformValues; // Same indices as m_Uniforms
+	std::vector<ShaderAttribute> m_Attributes;
+	std::vector<ShaderUniformBlock> m_UniformBlocks;
+	std::vector<std::unique_ptr<VertexBufferLayout>> m_Layouts; // Checked after every link
+	unsigned int m_LinkCount;
 public:
 	Shader(const std::string& filepath);
 	~Shader();
-	
+
 	void Bind() const;
 	void Unbind() const;
-	
+
+	// False while a ShaderLibrary is still compiling the program.
+	inline bool IsReady() const { return m_RendererID != 0; }
+	inline const std::string& GetFilePath() const { return m_FilePath; }
+
+	// Compute programs come from files with a "#shader compute" section and are
+	// run with Renderer::Dispatch instead of Renderer::Draw.
+	inline bool IsCompute() const { return m_IsCompute; }
+	inline const int* GetWorkGroupSize() const { return m_WorkGroupSize; }
+
+	UniformHandle GetUniformHandle(const char* name);
+
+	// Reflection, refreshed after every link.
+	inline const std::vector<ShaderAttribute>& GetAttributes() const { return m_Attributes; }
+	inline const std::vector<ShaderUniform>& GetUniforms() const { return m_Uniforms; }
+	inline const std::vector<ShaderUniformBlock>& GetUniformBlocks() const { return m_UniformBlocks; }
+	const ShaderUniformBlock* GetUniformBlock(const char* name) const;
+
+	// Reports attributes the layout doesn't feed or feeds with the wrong type.
+	bool ValidateLayout(const VertexBufferLayout& layout) const;
+	// Keeps a copy of the layout and validates against it now, if linked, and
+	// after every later link, so a hot reload is checked too.
+	void AddLayout(const VertexBufferLayout& layout);
+	// Programs swapped in so far. Anything that caches reflected data compares
+	// it to notice a reload.
+	inline unsigned int GetLinkCount() const { return m_LinkCount; }
+	void SetUniformBlockBinding(const char* name, unsigned int binding);
+
 	// Set Uniforms
-	void SetUniform1i(const std::string& name, int value);
-	void SetUniform1f(const std::string& name, float value);
-	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
-	
+	void SetUniform1i(UniformHandle handle, int value);
+	void SetUniform1f(UniformHandle handle, float value);
+	void SetUniform4f(UniformHandle handle, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(UniformHandle handle, const float* matrix); // Column-major
+	// A mat4 array from element 0. Arrays are not cached: every call reaches
+	// the driver and a hot reload does not restore them.
+	void SetUniformMat4fv(UniformHandle handle, const float* matrices, unsigned int count);
+
+	// Convenience versions, each call searches the uniform table by name.
+	void SetUniform1i(const char* name, int value);
+	void SetUniform1f(const char* name, float value);
+	void SetUniform4f(const char* name, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(const char* name, const float* matrix);
+
+	// glUniform calls made versus skipped because the value didn't change,
+	// summed over all shaders since the last reset. Reset once per frame.
+	static inline const UniformStats& GetUniformStats() { return s_UniformStats; }
+	static inline void ResetUniformStats() { s_UniformStats = { 0, 0 }; }
+
 private:
-	ShaderProgramSource ParseShader(const std::string& filepath);
-	unsigned int CompileShader(unsigned int type, const std::string& source);
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	int GetUniformLocation(const std::string& name);
-	
-};
+	friend class ShaderLibrary;
+
+	// A program handed to the driver whose status has not been queried yet.
+	struct PendingProgram
+	{
+		unsigned int Program;
+		unsigned int Stages[3]; // vertex, fragment, compute; 0 when unused
+	};
+
+	Shader(); // Used by ShaderLibrary, the program is filled in later.
 
+	// Splits the file on "#shader vertex"/"fragment"/"compute", expands
+	// #include "file" (relative to the including file) and adds a
+	// "#define NAME 1" after each stage's #version line for every define.
+	static ShaderProgramSource ParseShader(const std::string& filepath, const std::vector<std::string>& defines = {});
+	static unsigned int CompileShader(unsigned int type, const std::string& source);
+	static PendingProgram SubmitProgram(const ShaderProgramSource& source, bool retrievable = false);
+	static bool IsProgramComplete(const PendingProgram& pending);
+	static unsigned int FinishProgram(const PendingProgram& pending);
+	static void DeleteProgram(const PendingProgram& pending);
+	void SetProgram(unsigned int program);
+	void Reflect();
+	int FindUniform(const char* name) const;
+	UniformHandle AddUniform(const ShaderUniform& uniform);
+	bool UpdateUniformValue(UniformHandle handle, unsigned int componentType, const void* data, unsigned int count);
+	void RestoreUniformValues();
+	bool CheckUniformType(UniformHandle handle, unsigned int componentType, unsigned int count) const;
+
+	static UniformStats s_UniformStats;
+
+};
@@ -0,0 +1,179 @@
+#include "ShaderLibrary.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "Renderer.h"
+
+ShaderLibrary::ShaderLibrary()
+	: m_HotReload(false)
+{
+	// Let the driver use as many compiler threads as it wants.
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+	}
+	else if (GLEW_ARB_parallel_shader_compile)
+	{
+		GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+	}
+}
+
+ShaderLibrary::~ShaderLibrary()
+{
+	for (const PendingShader& pending : m_Pending)
+		Shader::DeleteProgram(pending.Program);
+}
+
+Shader* ShaderLibrary::Load(const std::string& name, const std::string& filepath, const std::vector<std::string>& defines)
+{
+	ASSERT(m_Shaders.find(name) == m_Shaders.end());
+
+	std::unique_ptr<Shader> shader(new Shader());
+	shader->m_FilePath = filepath;
+	shader->m_Defines = defines;
+	Submit(shader.get());
+
+	Shader* result = shader.get();
+	m_Shaders[name] = std::move(shader);
+	return result;
+}
+
+void ShaderLibrary::Submit(Shader* shader)
+{
+	ShaderProgramSource source = Shader::ParseShader(shader->m_FilePath, shader->m_Defines);
+	shader->m_Includes = source.Includes;
+	shader->m_IsCompute = !source.ComputeSource.empty();
+	if (m_HotReload)
+	{
+		m_Watcher.Watch(shader->m_FilePath);
+		for (const std::string& include : shader->m_Includes)
+			m_Watcher.Watch(include);
+	}
+
+	unsigned long long key = 0;
+	if (m_BinaryCache)
+	{
+		key = m_BinaryCache->GetKey(source);
+		unsigned int program = m_BinaryCache->Load(key);
+		if (program != 0)
+		{
+			shader->SetProgram(program);
+			return;
+		}
+	}
+
+	m_Pending.push_back({ shader, Shader::SubmitProgram(source, m_BinaryCache != nullptr), key });
+}
+
+Shader* ShaderLibrary::Get(const std::string& name) const
+{
+	auto it = m_Shaders.find(name);
+	if (it == m_Shaders.end())
+	{
+		std::cout << "Warning: shader '" << name << "' doesn't exist!" << std::endl;
+		return nullptr;
+	}
+	return it->second.get();
+}
+
+bool ShaderLibrary::Poll()
+{
+	if (m_HotReload)
+	{
+		std::vector<std::string> changed;
+		m_Watcher.Poll(changed);
+		for (const std::string& filepath : changed)
+			Reload(filepath);
+	}
+
+	for (unsigned int i = 0; i < m_Pending.size();)
+	{
+		PendingShader& pending = m_Pending[i];
+		if (!Shader::IsProgramComplete(pending.Program))
+		{
+			i++;
+			continue;
+		}
+
+		Finish(pending);
+		m_Pending[i] = m_Pending.back();
+		m_Pending.pop_back();
+	}
+	return m_Pending.empty();
+}
+
+void ShaderLibrary::WaitAll()
+{
+	// FinishProgram blocks on whatever is still compiling.
+	for (const PendingShader& pending : m_Pending)
+		Finish(pending);
+	m_Pending.clear();
+}
+
+void ShaderLibrary::EnableHotReload(bool enable)
+{
+	m_HotReload = enable;
+	if (enable)
+	{
+		for (const auto& entry : m_Shaders)
+		{
+			m_Watcher.Watch(entry.second->m_FilePath);
+			for (const std::string& include : entry.second->m_Includes)
+				m_Watcher.Watch(include);
+		}
+	}
+}
+
+void ShaderLibrary::EnableBinaryCache(const std::string& directory)
+{
+	m_BinaryCache.reset(new ProgramBinaryCache(directory));
+	if (!m_BinaryCache->IsSupported())
+	{
+		// Without ARB_get_program_binary the retrievable hint isn't even loaded.
+		std::cout << "Warning: driver has no program binary formats, binary cache disabled" << std::endl;
+		m_BinaryCache.reset();
+	}
+}
+
+void ShaderLibrary::Reload(const std::string& filepath)
+{
+	for (const auto& entry : m_Shaders)
+	{
+		Shader* shader = entry.second.get();
+		const std::vector<std::string>& includes = shader->m_Includes;
+		if (shader->m_FilePath != filepath && std::find(includes.begin(), includes.end(), filepath) == includes.end())
+			continue;
+
+		// A newer save replaces a rebuild that is still in flight.
+		for (unsigned int i = 0; i < m_Pending.size(); i++)
+		{
+			if (m_Pending[i].Target == shader)
+			{
+				Shader::DeleteProgram(m_Pending[i].Program);
+				m_Pending[i] = m_Pending.back();
+				m_Pending.pop_back();
+				break;
+			}
+		}
+
+		std::cout << "Reloading shader '" << entry.first << "'" << std::endl;
+		Submit(shader);
+	}
+}
+
+void ShaderLibrary::Finish(const PendingShader& pending)
+{
+	unsigned int program = Shader::FinishProgram(pending.Program);
+	Shader* shader = pending.Target;
+	if (program == 0)
+	{
+		// On a failed reload the old program stays in use.
+		std::cout << "Failed to build shader '" << shader->m_FilePath << "'" << std::endl;
+		return;
+	}
+
+	if (m_BinaryCache)
+		m_BinaryCache->Store(pending.CacheKey, program);
+	shader->SetProgram(program);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FileWatcher.h"
+#include "ProgramBinaryCache.h"
+#include "Shader.h"
+
+// Owns named shaders and compiles them without blocking the frame. Load() hands
+// every compile and link to the driver up front; Poll() picks up the programs
+// that finished, using KHR_parallel_shader_compile when the driver has it.
+// With hot reload on, edited shader files are rebuilt the same way and only
+// swapped into their Shader once the new program linked. With a binary cache,
+// programs built once are loaded from disk instead of compiled.
+class ShaderLibrary
+{
+private:
+	struct PendingShader
+	{
+		Shader* Target;
+		Shader::PendingProgram Program;
+		unsigned long long CacheKey;
+	};
+
+	std::unordered_map<std::string, std::unique_ptr<Shader>> m_Shaders;
+	std::vector<PendingShader> m_Pending;
+	FileWatcher m_Watcher;
+	bool m_HotReload;
+	std::unique_ptr<ProgramBinaryCache> m_BinaryCache;
+public:
+	ShaderLibrary();
+	~ShaderLibrary();
+
+	// Returns right away; the shader is not ready until Poll() finishes it.
+	Shader* Load(const std::string& name, const std::string& filepath, const std::vector<std::string>& defines = {});
+	Shader* Get(const std::string& name) const;
+
+	// Non-blocking. Returns true once nothing is left compiling.
+	bool Poll();
+	void WaitAll();
+
+	void EnableHotReload(bool enable);
+	void EnableBinaryCache(const std::string& directory);
+
+	inline unsigned int GetPendingCount() const { return (unsigned int)m_Pending.size(); }
+private:
+	void Submit(Shader* shader);
+	void Reload(const std::string& filepath);
+	void Finish(const PendingShader& pending);
+};
@@ -0,0 +1,74 @@
+#include "ShaderReflection.h"
+
+#include <GL/glew.h>
+
+namespace ShaderReflection
+{
+	const char* GetTypeName(unsigned int type)
+	{
+		switch (type)
+		{
+			case GL_FLOAT:             return "float";
+			case GL_FLOAT_VEC2:        return "vec2";
+			case GL_FLOAT_VEC3:        return "vec3";
+			case GL_FLOAT_VEC4:        return "vec4";
+			case GL_INT:               return "int";
+			case GL_INT_VEC2:          return "ivec2";
+			case GL_INT_VEC3:          return "ivec3";
+			case GL_INT_VEC4:          return "ivec4";
+			case GL_UNSIGNED_INT:      return "uint";
+			case GL_UNSIGNED_INT_VEC2: return "uvec2";
+			case GL_UNSIGNED_INT_VEC3: return "uvec3";
+			case GL_UNSIGNED_INT_VEC4: return "uvec4";
+			case GL_BOOL:              return "bool";
+			case GL_BOOL_VEC2:         return "bvec2";
+			case GL_BOOL_VEC3:         return "bvec3";
+			case GL_BOOL_VEC4:         return "bvec4";
+			case GL_FLOAT_MAT2:        return "mat2";
+			case GL_FLOAT_MAT3:        return "mat3";
+			case GL_FLOAT_MAT4:        return "mat4";
+			case GL_DOUBLE:            return "double";
+			case GL_SAMPLER_2D:        return "sampler2D";
+			case GL_SAMPLER_3D:        return "sampler3D";
+			case GL_SAMPLER_CUBE:      return "samplerCube";
+			case GL_SAMPLER_2D_ARRAY:  return "sampler2DArray";
+		}
+		return "unknown";
+	}
+
+	unsigned int GetComponentType(unsigned int type)
+	{
+		switch (type)
+		{
+			case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+			case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+				return GL_FLOAT;
+			case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+				return GL_UNSIGNED_INT;
+			case GL_BOOL: case GL_BOOL_VEC2: case GL_BOOL_VEC3: case GL_BOOL_VEC4:
+				return GL_BOOL;
+			case GL_DOUBLE:
+				return GL_DOUBLE;
+		}
+		return GL_INT; // ints and samplers
+	}
+
+	unsigned int GetComponentCount(unsigned int type)
+	{
+		switch (type)
+		{
+			case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2:
+				return 2;
+			case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3:
+				return 3;
+			case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4:
+			case GL_FLOAT_MAT2:
+				return 4;
+			case GL_FLOAT_MAT3:
+				return 9;
+			case GL_FLOAT_MAT4:
+				return 16;
+		}
+		return 1;
+	}
+}
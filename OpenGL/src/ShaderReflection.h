@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// What the driver reports about a linked program. Filled by Shader after every
+// link; types are the GL enums (GL_FLOAT_VEC4, GL_SAMPLER_2D, ...).
+
+struct ShaderAttribute
+{
+	std::string Name;
+	int Location;
+	unsigned int Type;
+	int Size;
+};
+
+struct ShaderUniform
+{
+	std::string Name;
+	int Location;     // -1 for uniform block members
+	unsigned int Type;
+	int Size;         // Array length, 1 for plain uniforms
+	int BlockIndex;   // -1 outside of a uniform block
+	int Offset;       // Byte offsets inside the block, -1 outside of it
+	int ArrayStride;
+	int MatrixStride;
+};
+
+struct ShaderUniformBlock
+{
+	std::string Name;
+	unsigned int Index;
+	int DataSize;
+	std::vector<ShaderUniform> Members;
+};
+
+namespace ShaderReflection
+{
+	const char* GetTypeName(unsigned int type);
+	// Scalar type a GLSL type is made of: GL_FLOAT, GL_INT, GL_UNSIGNED_INT,
+	// GL_BOOL or GL_DOUBLE. Samplers count as GL_INT.
+	unsigned int GetComponentType(unsigned int type);
+	unsigned int GetComponentCount(unsigned int type);
+}
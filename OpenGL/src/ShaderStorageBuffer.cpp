@@ -0,0 +1,44 @@
+#include "ShaderStorageBuffer.h"
+#include "Renderer.h"
+
+ShaderStorageBuffer::ShaderStorageBuffer(const void* data, unsigned int size)
+	: m_Size(size)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+	GLCall(glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_COPY));
+}
+
+ShaderStorageBuffer::~ShaderStorageBuffer()
+{
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+void ShaderStorageBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+	ASSERT(offset + size <= m_Size);
+	Bind();
+	GLCall(glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data));
+}
+
+void ShaderStorageBuffer::GetData(void* data, unsigned int size, unsigned int offset) const
+{
+	ASSERT(offset + size <= m_Size);
+	Bind();
+	GLCall(glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data));
+}
+
+void ShaderStorageBuffer::BindBase(unsigned int binding) const
+{
+	GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_RendererID));
+}
+
+void ShaderStorageBuffer::Bind() const
+{
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID));
+}
+
+void ShaderStorageBuffer::Unbind() const
+{
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+// GL_SHADER_STORAGE_BUFFER for compute shaders. Needs OpenGL 4.3.
+class ShaderStorageBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+public:
+	ShaderStorageBuffer(const void* data, unsigned int size);
+	~ShaderStorageBuffer();
+
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+	// Blocks until the GPU is done writing; call Renderer::Barrier first.
+	void GetData(void* data, unsigned int size, unsigned int offset = 0) const;
+
+	// Binds to the "layout(std430, binding = N) buffer" slot.
+	void BindBase(unsigned int binding) const;
+	void Bind() const;
+	void Unbind() const;
+
+	// The same buffer can be drawn as vertices once compute is done with it.
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+};
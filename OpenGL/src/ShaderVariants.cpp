@@ -0,0 +1,49 @@
+#include "ShaderVariants.h"
+
+#include <iostream>
+
+#include "Renderer.h"
+#include "ShaderLibrary.h"
+
+ShaderVariants::ShaderVariants(ShaderLibrary& library, const std::string& name, const std::string& filepath,
+	const std::vector<std::string>& keywords)
+	: m_Library(library), m_Name(name), m_FilePath(filepath), m_Keywords(keywords)
+{
+	ASSERT(keywords.size() <= 32);
+}
+
+unsigned int ShaderVariants::GetKeywordMask(const char* keyword) const
+{
+	for (unsigned int i = 0; i < m_Keywords.size(); i++)
+	{
+		if (m_Keywords[i] == keyword)
+			return 1u << i;
+	}
+	std::cout << "Warning: shader '" << m_Name << "' has no keyword '" << keyword << "'" << std::endl;
+	return 0;
+}
+
+Shader* ShaderVariants::Get(unsigned int mask)
+{
+	auto it = m_Variants.find(mask);
+	if (it != m_Variants.end())
+		return it->second;
+
+	std::vector<std::string> defines;
+	for (unsigned int i = 0; i < m_Keywords.size(); i++)
+	{
+		if (mask & (1u << i))
+			defines.push_back(m_Keywords[i]);
+	}
+
+	Shader* shader = m_Library.Load(m_Name + "#" + std::to_string(mask), m_FilePath, defines);
+	m_Variants[mask] = shader;
+	return shader;
+}
+
+void ShaderVariants::Precompile(const std::vector<unsigned int>& masks)
+{
+	// Submitting them all before anyone polls lets the driver compile in parallel.
+	for (unsigned int mask : masks)
+		Get(mask);
+}
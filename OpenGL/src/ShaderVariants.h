@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Shader;
+class ShaderLibrary;
+
+// All variants of one shader file, selected by a bitmask of keywords. Bit i
+// turns on "#define keywords[i] 1". A variant is compiled the first time it is
+// asked for (without blocking, like everything in ShaderLibrary), so callers
+// should Precompile() the ones they know they'll need at load time.
+class ShaderVariants
+{
+private:
+	ShaderLibrary& m_Library;
+	std::string m_Name;
+	std::string m_FilePath;
+	std::vector<std::string> m_Keywords;
+	std::unordered_map<unsigned int, Shader*> m_Variants;
+public:
+	ShaderVariants(ShaderLibrary& library, const std::string& name, const std::string& filepath,
+		const std::vector<std::string>& keywords);
+
+	unsigned int GetKeywordMask(const char* keyword) const;
+
+	Shader* Get(unsigned int mask);
+	void Precompile(const std::vector<unsigned int>& masks);
+
+	inline unsigned int GetVariantCount() const { return (unsigned int)m_Variants.size(); }
+};
@@ -1,37 +1,273 @@
 #include "Texture.h"
 
+#include <iostream>
+
+#include "TextureCompression.h"
 #include "vendor\stb_image\stb_image.h"
 
+std::map<unsigned int, size_t> Texture::s_MemoryByFormat;
+
 Texture::Texture(const std::string & path)
-	: m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
+	: m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0), m_Format(GL_RGBA8), m_GPUMemory(0), m_DecodeStats{ 0, 0, 0 }, m_Loaded(true),
+	  m_Sampler(SamplerCache::Get(SamplerState::Default()))
 {
+	if (TextureCompression::IsCompressedFile(path))
+	{
+		CompressedImage image;
+		if (TextureCompression::Load(path, image))
+		{
+			m_RendererID = CreateCompressedTexture(image);
+			m_Width = image.Width;
+			m_Height = image.Height;
+			m_BPP = 4;
+			SetGPUMemory(image.Format, (unsigned int)image.Data.size());
+		}
+		if (m_RendererID == 0)
+			CreatePlaceholder();
+		return;
+	}
+
 	stbi_set_flip_vertically_on_load(1);
-	m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+	m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 0);
+	// glTexStorage2D rejects a 0x0 texture, a missing file gets the placeholder.
+	if (m_LocalBuffer && m_Width > 0 && m_Height > 0)
+	{
+		m_RendererID = CreateTexture(m_Width, m_Height, m_LocalBuffer, m_BPP);
+		SetGPUMemory(GetFormat(m_BPP), GetMemorySize(m_Width, m_Height, m_BPP));
+	}
+	else
+	{
+		std::cout << "Failed to load texture '" << path << "': " << stbi_failure_reason() << std::endl;
+		CreatePlaceholder();
+	}
 
-	GLCall(glGenTextures(1, &m_RendererID));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	if (m_LocalBuffer)
+		stbi_image_free(m_LocalBuffer);
+	m_LocalBuffer = nullptr;
+	m_DecodeStats = ImageArena::Reset();
+}
+
+Texture::Texture(int width, int height, const unsigned char* pixels, int channels)
+	: m_RendererID(0), m_LocalBuffer(nullptr), m_Width(width), m_Height(height), m_BPP(channels), m_Format(GL_RGBA8), m_GPUMemory(0), m_DecodeStats{ 0, 0, 0 }, m_Loaded(true),
+	  m_Sampler(SamplerCache::Get(SamplerState::Default()))
+{
+	if (width <= 0 || height <= 0)
+	{
+		CreatePlaceholder();
+		return;
+	}
+	m_RendererID = CreateTexture(width, height, pixels, channels);
+	SetGPUMemory(GetFormat(channels), GetMemorySize(width, height, channels));
+}
+
+Texture::Texture()
+	: m_RendererID(0), m_LocalBuffer(nullptr), m_Width(1), m_Height(1), m_BPP(4), m_Format(GL_RGBA8), m_GPUMemory(0), m_DecodeStats{ 0, 0, 0 }, m_Loaded(false),
+	  m_Sampler(SamplerCache::Get(SamplerState::Default()))
+{
+	CreatePlaceholder();
+}
+
+Texture::~Texture()
+{
+	SetGPUMemory(m_Format, 0);
+	GLCall(glDeleteTextures(1, &m_RendererID));
+}
+
+void Texture::CreatePlaceholder()
+{
+	const unsigned char white[] = { 255, 255, 255, 255 };
+	m_RendererID = CreateTexture(1, 1, white);
+	m_Width = m_Height = 1;
+	m_BPP = 4;
+	SetGPUMemory(GL_RGBA8, GetMemorySize(1, 1));
+}
+
+unsigned int Texture::GetMipLevelCount(int width, int height)
+{
+	unsigned int levels = 1;
+	for (int size = width > height ? width : height; size > 1; size /= 2)
+		levels++;
+	return levels;
+}
+
+unsigned int Texture::GetMemorySize(int width, int height, int channels)
+{
+	// Drivers may pad RGB8 to four bytes; this is what we asked for.
+	unsigned int size = 0;
+	for (unsigned int level = 0; level < GetMipLevelCount(width, height); level++)
+	{
+		size += width * height * channels;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	return size;
+}
+
+unsigned int Texture::GetFormat(int channels)
+{
+	switch (channels)
+	{
+		case 1: return GL_R8;
+		case 2: return GL_RG8;
+		case 3: return GL_RGB8;
+	}
+	return GL_RGBA8;
+}
+
+unsigned int Texture::GetPixelFormat(int channels)
+{
+	switch (channels)
+	{
+		case 1: return GL_RED;
+		case 2: return GL_RG;
+		case 3: return GL_RGB;
+	}
+	return GL_RGBA;
+}
+
+const char* Texture::GetFormatName(unsigned int format)
+{
+	switch (format)
+	{
+		case GL_R8:    return "R8";
+		case GL_RG8:   return "RG8";
+		case GL_RGB8:  return "RGB8";
+		case GL_RGBA8: return "RGBA8";
+	}
+	return TextureCompression::GetFormatName(format);
+}
 
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+void Texture::SetSwizzle(int channels)
+{
+	// Gray and gray + alpha images come in as R and RG.
+	const int gray[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+	const int grayAlpha[] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+	const int rgb[] = { GL_RED, GL_GREEN, GL_BLUE, GL_ONE };
+	const int rgba[] = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
+	const int* swizzle = channels == 1 ? gray : channels == 2 ? grayAlpha : channels == 3 ? rgb : rgba;
+	GLCall(glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle));
+}
+
+unsigned int Texture::CreateTexture(int width, int height, const void* pixels, int channels)
+{
+	unsigned int rendererID;
+	GLCall(glGenTextures(1, &rendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D, rendererID));
+
+	// Filtering and wrapping come from the Sampler bound next to the texture.
+	unsigned int levels = GetMipLevelCount(width, height);
+	unsigned int format = GetFormat(channels);
+	unsigned int pixelFormat = GetPixelFormat(channels);
+	// Rows of 1 to 3 channel images aren't necessarily 4-byte aligned.
+	if (channels != 4)
+	{
+		GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	}
+	if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage)
+	{
+		GLCall(glTexStorage2D(GL_TEXTURE_2D, levels, format, width, height));
+		GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, pixelFormat, GL_UNSIGNED_BYTE, pixels));
+	}
+	else
+	{
+		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, pixelFormat, GL_UNSIGNED_BYTE, pixels));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1));
+	}
+	if (channels != 4)
+	{
+		GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+		SetSwizzle(channels);
+	}
+	if (levels > 1)
+	{
+		GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+	}
 
-	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
 	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	return rendererID;
+}
 
-	if (m_LocalBuffer)
-		stbi_image_free(m_LocalBuffer);
+unsigned int Texture::CreateCompressedTexture(const CompressedImage& image)
+{
+	if (!TextureCompression::IsFormatSupported(image.Format))
+	{
+		std::cout << "Warning: " << TextureCompression::GetFormatName(image.Format)
+			<< " textures are not supported by this driver" << std::endl;
+		return 0;
+	}
+	if (image.Width <= 0 || image.Height <= 0 || image.Levels.empty())
+	{
+		std::cout << "Warning: compressed texture has no image data" << std::endl;
+		return 0;
+	}
+
+	unsigned int rendererID;
+	GLCall(glGenTextures(1, &rendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D, rendererID));
+
+	unsigned int levels = (unsigned int)image.Levels.size();
+	if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage)
+	{
+		GLCall(glTexStorage2D(GL_TEXTURE_2D, levels, image.Format, image.Width, image.Height));
+		for (unsigned int level = 0; level < levels; level++)
+		{
+			const CompressedImage::Level& data = image.Levels[level];
+			GLCall(glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, data.Width, data.Height, image.Format,
+				data.Size, &image.Data[data.Offset]));
+		}
+	}
+	else
+	{
+		for (unsigned int level = 0; level < levels; level++)
+		{
+			const CompressedImage::Level& data = image.Levels[level];
+			GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, level, image.Format, data.Width, data.Height, 0,
+				data.Size, &image.Data[data.Offset]));
+		}
+	}
+	// A file without the full chain would otherwise be incomplete with mip filtering.
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1));
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	return rendererID;
 }
 
-Texture::~Texture()
+void Texture::SetImage(unsigned int rendererID, int width, int height, int channels)
 {
 	GLCall(glDeleteTextures(1, &m_RendererID));
+	m_RendererID = rendererID;
+	m_Width = width;
+	m_Height = height;
+	m_BPP = channels;
+	SetGPUMemory(GetFormat(channels), GetMemorySize(width, height, channels));
+	m_Loaded = true;
+}
+
+void Texture::SetGPUMemory(unsigned int format, unsigned int bytes)
+{
+	if (m_GPUMemory > 0)
+	{
+		size_t& used = s_MemoryByFormat[m_Format];
+		used -= m_GPUMemory;
+		if (used == 0)
+			s_MemoryByFormat.erase(m_Format);
+	}
+	m_Format = format;
+	m_GPUMemory = bytes;
+	if (bytes > 0)
+		s_MemoryByFormat[format] += bytes;
+}
+
+void Texture::SetSampler(const SamplerState& state)
+{
+	m_Sampler = SamplerCache::Get(state);
 }
 
 void Texture::Bind(unsigned int slot) const
 {
 	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
 	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	m_Sampler->Bind(slot);
 }
 
 void Texture::Unbind() const
@@ -1,7 +1,18 @@
 #pragma once
 
+#include <map>
+#include <memory>
+
+#include "ImageArena.h"
 #include "Renderer.h"
+#include "Sampler.h"
+
+struct CompressedImage;
 
+// Loads PNG/JPG/... through stb_image, or .dds/.ktx files straight into a
+// compressed GPU format (see TextureCompression). Images keep the channel
+// count of the file (R8, RG8, RGB8 or RGBA8); swizzling makes every format
+// sample as RGBA in shaders: gray as (g, g, g, 1), gray + alpha as (g, g, g, a).
 class Texture
 {
 private:
@@ -9,8 +20,15 @@ private:
 	std::string m_FilePath;
 	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP;
+	unsigned int m_Format; // GL internal format
+	unsigned int m_GPUMemory;
+	ImageArenaStats m_DecodeStats;
+	bool m_Loaded;
+	std::shared_ptr<Sampler> m_Sampler;
 public:
 	Texture(const std::string& path);
+	// 1 to 4 channel pixels, rows bottom to top like stb_image loads them for us.
+	Texture(int width, int height, const unsigned char* pixels, int channels = 4);
 	~Texture();
 
 	void Bind(unsigned int slot = 0) const;
@@ -18,5 +36,49 @@ public:
 
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
-};
+	inline const std::string& GetFilePath() const { return m_FilePath; }
+	inline unsigned int GetFormat() const { return m_Format; }
+	// Bytes of video memory used by all mip levels.
+	inline unsigned int GetGPUMemory() const { return m_GPUMemory; }
+	// Allocations stb_image made decoding the file; zero for .dds/.ktx.
+	inline const ImageArenaStats& GetDecodeStats() const { return m_DecodeStats; }
+
+	// Defaults to SamplerState::Default(); the sampler is shared through SamplerCache.
+	void SetSampler(const SamplerState& state);
+	inline const Sampler& GetSampler() const { return *m_Sampler; }
+
+	static unsigned int GetMipLevelCount(int width, int height);
+	// Uncompressed, with a full mip chain.
+	static unsigned int GetMemorySize(int width, int height, int channels = 4);
+	// GL_R8, GL_RG8, GL_RGB8 or GL_RGBA8.
+	static unsigned int GetFormat(int channels);
+	static const char* GetFormatName(unsigned int format);
+
+	// Video memory of all live textures by internal format.
+	static inline const std::map<unsigned int, size_t>& GetMemoryByFormat() { return s_MemoryByFormat; }
 
+	// False while a TextureLoader still shows the placeholder.
+	inline bool IsLoaded() const { return m_Loaded; }
+private:
+	friend class TextureLoader;
+	friend class TextureStreamer;
+
+	Texture(); // 1x1 white placeholder, used by TextureLoader and TextureStreamer.
+
+	// Creates a GL_TEXTURE_2D with a full mip chain, immutable when the driver
+	// has glTexStorage2D. With a pixel unpack buffer bound, pixels is an offset
+	// into it.
+	static unsigned int CreateTexture(int width, int height, const void* pixels, int channels = 4);
+	// Format of the client pixels, and the swizzle for the bound texture.
+	static unsigned int GetPixelFormat(int channels);
+	static void SetSwizzle(int channels);
+	// Returns 0 when the driver can't sample the format or the image is empty.
+	static unsigned int CreateCompressedTexture(const CompressedImage& image);
+	// 1x1 white, for files that fail to load.
+	void CreatePlaceholder();
+	void SetImage(unsigned int rendererID, int width, int height, int channels);
+	// Keeps s_MemoryByFormat in step with m_Format and m_GPUMemory.
+	void SetGPUMemory(unsigned int format, unsigned int bytes);
+
+	static std::map<unsigned int, size_t> s_MemoryByFormat;
+};
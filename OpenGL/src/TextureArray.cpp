@@ -0,0 +1,105 @@
+#include "TextureArray.h"
+
+#include <iostream>
+
+#include "ImageArena.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "vendor\stb_image\stb_image.h"
+
+TextureArray::TextureArray(const std::vector<std::string>& paths)
+	: m_RendererID(0), m_Width(0), m_Height(0), m_Sampler(SamplerCache::Get(SamplerState::Default()))
+{
+	int maxLayers = 0;
+	GLCall(glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers));
+
+	std::vector<std::vector<unsigned char>> images;
+	stbi_set_flip_vertically_on_load(1);
+	for (const std::string& path : paths)
+	{
+		int width, height, bpp;
+		unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &bpp, 4);
+		if (!pixels)
+		{
+			std::cout << "Failed to load texture '" << path << "': " << stbi_failure_reason() << std::endl;
+			ImageArena::Reset();
+			continue;
+		}
+		// Copied out so the decoder's scratch memory is reused by the next image.
+		std::vector<unsigned char> image(pixels, pixels + width * height * 4);
+		stbi_image_free(pixels);
+		ImageArena::Reset();
+		if (images.empty())
+		{
+			m_Width = width;
+			m_Height = height;
+		}
+		if (width != m_Width || height != m_Height || (int)images.size() == maxLayers)
+		{
+			std::cout << "Warning: '" << path << "' skipped, texture arrays need " << m_Width << "x" << m_Height
+				<< " images and at most " << maxLayers << " layers" << std::endl;
+			continue;
+		}
+		images.push_back(std::move(image));
+		m_Layers.push_back(path);
+	}
+	if (images.empty())
+		return;
+
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+
+	unsigned int levels = Texture::GetMipLevelCount(m_Width, m_Height);
+	int layers = (int)images.size();
+	if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage)
+	{
+		GLCall(glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, m_Width, m_Height, layers));
+	}
+	else
+	{
+		GLCall(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, m_Width, m_Height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+		GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1));
+	}
+
+	for (int layer = 0; layer < layers; layer++)
+	{
+		GLCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_Width, m_Height, 1, GL_RGBA, GL_UNSIGNED_BYTE, images[layer].data()));
+	}
+	if (levels > 1)
+	{
+		GLCall(glGenerateMipmap(GL_TEXTURE_2D_ARRAY));
+	}
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+}
+
+TextureArray::~TextureArray()
+{
+	GLCall(glDeleteTextures(1, &m_RendererID));
+}
+
+void TextureArray::Bind(unsigned int slot) const
+{
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+	m_Sampler->Bind(slot);
+}
+
+void TextureArray::Unbind() const
+{
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+}
+
+int TextureArray::GetLayer(const std::string& path) const
+{
+	for (unsigned int i = 0; i < m_Layers.size(); i++)
+	{
+		if (m_Layers[i] == path)
+			return i;
+	}
+	return -1;
+}
+
+void TextureArray::SetSampler(const SamplerState& state)
+{
+	m_Sampler = SamplerCache::Get(state);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Sampler.h"
+
+// Same-sized images stored as the layers of one GL_TEXTURE_2D_ARRAY. A batch
+// can then reference all of them with one binding: each vertex carries its
+// layer index (see res/shaders/Batch.shader) instead of the draw switching
+// textures.
+class TextureArray
+{
+private:
+	unsigned int m_RendererID;
+	int m_Width, m_Height;
+	std::vector<std::string> m_Layers;
+	std::shared_ptr<Sampler> m_Sampler;
+public:
+	// Layer size is taken from the first image; others of a different size are skipped.
+	TextureArray(const std::vector<std::string>& paths);
+	~TextureArray();
+
+	void Bind(unsigned int slot = 0) const;
+	void Unbind() const;
+
+	// -1 when the image isn't in the array.
+	int GetLayer(const std::string& path) const;
+	void SetSampler(const SamplerState& state);
+
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	inline unsigned int GetLayerCount() const { return (unsigned int)m_Layers.size(); }
+};
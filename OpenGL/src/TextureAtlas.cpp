@@ -0,0 +1,223 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "ImageArena.h"
+#include "vendor\stb_image\stb_image.h"
+
+SkylinePacker::SkylinePacker(int width, int height)
+	: m_Width(width), m_Height(height), m_UsedArea(0)
+{
+	m_Skyline.push_back({ 0, 0, width });
+}
+
+int SkylinePacker::Fit(unsigned int index, int width, int height) const
+{
+	// Lowest y at which the rectangle can sit starting at segment index.
+	int x = m_Skyline[index].X;
+	if (x + width > m_Width)
+		return -1;
+
+	int y = 0;
+	int remaining = width;
+	for (unsigned int i = index; remaining > 0; i++)
+	{
+		if (i == m_Skyline.size())
+			return -1;
+		y = std::max(y, m_Skyline[i].Y);
+		if (y + height > m_Height)
+			return -1;
+		remaining -= m_Skyline[i].Width;
+	}
+	return y;
+}
+
+bool SkylinePacker::Insert(int width, int height, int& x, int& y)
+{
+	// Unbounded, so a rectangle as tall or as wide as the page is accepted.
+	int bestIndex = -1, bestY = INT_MAX, bestWidth = INT_MAX;
+	for (unsigned int i = 0; i < m_Skyline.size(); i++)
+	{
+		int fitY = Fit(i, width, height);
+		if (fitY < 0)
+			continue;
+		if (fitY + height < bestY || (fitY + height == bestY && m_Skyline[i].Width < bestWidth))
+		{
+			bestIndex = i;
+			bestY = fitY + height;
+			bestWidth = m_Skyline[i].Width;
+		}
+	}
+	if (bestIndex < 0)
+		return false;
+
+	x = m_Skyline[bestIndex].X;
+	y = bestY - height;
+
+	// Raise the skyline under the new rectangle and trim what it covers.
+	m_Skyline.insert(m_Skyline.begin() + bestIndex, { x, y + height, width });
+	for (unsigned int i = bestIndex + 1; i < m_Skyline.size();)
+	{
+		Segment& segment = m_Skyline[i];
+		int covered = x + width - segment.X;
+		if (covered <= 0)
+			break;
+		if (covered < segment.Width)
+		{
+			segment.X += covered;
+			segment.Width -= covered;
+			break;
+		}
+		m_Skyline.erase(m_Skyline.begin() + i);
+	}
+	for (unsigned int i = 0; i + 1 < m_Skyline.size();)
+	{
+		if (m_Skyline[i].Y == m_Skyline[i + 1].Y)
+		{
+			m_Skyline[i].Width += m_Skyline[i + 1].Width;
+			m_Skyline.erase(m_Skyline.begin() + i + 1);
+		}
+		else
+			i++;
+	}
+
+	m_UsedArea += (long long)width * height;
+	return true;
+}
+
+struct AtlasImage
+{
+	std::string Path;
+	std::vector<unsigned char> Pixels;
+	int Width, Height;
+};
+
+// Copies the image into the page and smears its edge pixels over the gutter.
+static void Blit(std::vector<unsigned char>& page, int pageSize, const AtlasImage& image, int x, int y, int padding)
+{
+	for (int row = -padding; row < image.Height + padding; row++)
+	{
+		int srcRow = std::min(std::max(row, 0), image.Height - 1);
+		for (int col = -padding; col < image.Width + padding; col++)
+		{
+			int srcCol = std::min(std::max(col, 0), image.Width - 1);
+			const unsigned char* src = &image.Pixels[(srcRow * image.Width + srcCol) * 4];
+			unsigned char* dst = &page[((y + row) * pageSize + (x + col)) * 4];
+			memcpy(dst, src, 4);
+		}
+	}
+}
+
+TextureAtlas::TextureAtlas(const std::vector<std::string>& paths, int pageSize, int padding)
+	: m_PageSize(pageSize), m_Padding(padding), m_ImageArea(0)
+{
+	std::vector<AtlasImage> images;
+	stbi_set_flip_vertically_on_load(1);
+	for (const std::string& path : paths)
+	{
+		AtlasImage image = { path, {}, 0, 0 };
+		int bpp;
+		unsigned char* pixels = stbi_load(path.c_str(), &image.Width, &image.Height, &bpp, 4);
+		if (!pixels)
+		{
+			std::cout << "Failed to load texture '" << path << "': " << stbi_failure_reason() << std::endl;
+			ImageArena::Reset();
+			continue;
+		}
+		// Copied out so the decoder's scratch memory is reused by the next image.
+		image.Pixels.assign(pixels, pixels + image.Width * image.Height * 4);
+		stbi_image_free(pixels);
+		ImageArena::Reset();
+		if (image.Width + 2 * padding > pageSize || image.Height + 2 * padding > pageSize)
+		{
+			std::cout << "Warning: '" << path << "' doesn't fit in a " << pageSize << " atlas page" << std::endl;
+			continue;
+		}
+		images.push_back(std::move(image));
+	}
+
+	// Tallest first packs a skyline much tighter.
+	std::sort(images.begin(), images.end(), [](const AtlasImage& a, const AtlasImage& b)
+	{
+		return a.Height != b.Height ? a.Height > b.Height : a.Width > b.Width;
+	});
+
+	std::vector<SkylinePacker> packers;
+	std::vector<std::vector<unsigned char>> pages;
+	for (const AtlasImage& image : images)
+	{
+		int x = 0, y = 0;
+		unsigned int page = 0;
+		for (; page < packers.size(); page++)
+		{
+			if (packers[page].Insert(image.Width + 2 * padding, image.Height + 2 * padding, x, y))
+				break;
+		}
+		if (page == packers.size())
+		{
+			SkylinePacker packer(pageSize, pageSize);
+			if (!packer.Insert(image.Width + 2 * padding, image.Height + 2 * padding, x, y))
+			{
+				std::cout << "Error: '" << image.Path << "' doesn't fit in an empty atlas page" << std::endl;
+				continue;
+			}
+			packers.push_back(packer);
+			pages.emplace_back((size_t)pageSize * pageSize * 4, 0);
+		}
+
+		x += padding;
+		y += padding;
+		Blit(pages[page], pageSize, image, x, y, padding);
+
+		AtlasRegion region;
+		region.Page = page;
+		region.X = x;
+		region.Y = y;
+		region.Width = image.Width;
+		region.Height = image.Height;
+		region.U0 = (float)x / pageSize;
+		region.V0 = (float)y / pageSize;
+		region.U1 = (float)(x + image.Width) / pageSize;
+		region.V1 = (float)(y + image.Height) / pageSize;
+		m_Regions[image.Path] = region;
+		m_ImageArea += (long long)image.Width * image.Height;
+	}
+
+	for (const std::vector<unsigned char>& page : pages)
+		m_Pages.emplace_back(new Texture(pageSize, pageSize, page.data()));
+
+	std::cout << "Atlas: " << m_Regions.size() << " images in " << m_Pages.size() << " pages, "
+		<< (int)(GetEfficiency() * 100.0f) << "% used" << std::endl;
+}
+
+const AtlasRegion* TextureAtlas::GetRegion(const std::string& path) const
+{
+	auto it = m_Regions.find(path);
+	return it == m_Regions.end() ? nullptr : &it->second;
+}
+
+float TextureAtlas::GetEfficiency() const
+{
+	if (m_Pages.empty())
+		return 0.0f;
+	return (float)m_ImageArea / ((float)m_PageSize * m_PageSize * m_Pages.size());
+}
+
+bool TextureAtlas::WriteRegions(const std::string& filepath) const
+{
+	std::ofstream stream(filepath);
+	if (!stream)
+		return false;
+
+	for (const auto& entry : m_Regions)
+	{
+		const AtlasRegion& region = entry.second;
+		stream << entry.first << ' ' << region.Page << ' ' << region.U0 << ' ' << region.V0 << ' '
+			<< region.U1 << ' ' << region.V1 << '\n';
+	}
+	return true;
+}
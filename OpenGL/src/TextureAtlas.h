@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Texture.h"
+
+// Where an image ended up inside an atlas page. UVs cover the image itself,
+// not the gutter around it.
+struct AtlasRegion
+{
+	unsigned int Page;
+	int X, Y, Width, Height;
+	float U0, V0, U1, V1;
+};
+
+// Bottom-left skyline rectangle packer.
+class SkylinePacker
+{
+private:
+	struct Segment
+	{
+		int X, Y, Width;
+	};
+
+	int m_Width, m_Height;
+	std::vector<Segment> m_Skyline;
+	long long m_UsedArea;
+public:
+	SkylinePacker(int width, int height);
+
+	bool Insert(int width, int height, int& x, int& y);
+
+	inline float GetOccupancy() const { return (float)m_UsedArea / ((float)m_Width * m_Height); }
+private:
+	int Fit(unsigned int index, int width, int height) const;
+};
+
+// Packs many images into a few large textures so sprites from different files
+// can be drawn in one batch. Every image gets a gutter of `padding` pixels
+// filled with copies of its edge, which keeps bilinear filtering and the first
+// mip levels from bleeding in the neighbours.
+class TextureAtlas
+{
+private:
+	int m_PageSize;
+	int m_Padding;
+	std::vector<std::unique_ptr<Texture>> m_Pages;
+	std::unordered_map<std::string, AtlasRegion> m_Regions;
+	long long m_ImageArea;
+public:
+	TextureAtlas(const std::vector<std::string>& paths, int pageSize = 2048, int padding = 4);
+
+	const AtlasRegion* GetRegion(const std::string& path) const;
+	inline const Texture& GetPage(unsigned int page) const { return *m_Pages[page]; }
+	inline unsigned int GetPageCount() const { return (unsigned int)m_Pages.size(); }
+
+	// Image pixels over page pixels, gutters count as waste.
+	float GetEfficiency() const;
+
+	// Writes "path page u0 v0 u1 v1" per line, for tools that build offline.
+	bool WriteRegions(const std::string& filepath) const;
+};
@@ -0,0 +1,616 @@
+#include "TextureCompression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <GL/glew.h>
+
+#include "ImageArena.h"
+#include "vendor\stb_image\stb_image.h"
+
+namespace TextureCompression
+{
+	static const unsigned int DDS_MAGIC = 0x20534444; // "DDS "
+	static const unsigned int FOURCC_DXT1 = 0x31545844;
+	static const unsigned int FOURCC_DXT5 = 0x35545844;
+	static const unsigned int FOURCC_DX10 = 0x30315844;
+	static const unsigned int DXGI_FORMAT_BC1_UNORM = 71;
+	static const unsigned int DXGI_FORMAT_BC3_UNORM = 77;
+	static const unsigned int DXGI_FORMAT_BC7_UNORM = 98;
+	static const unsigned int DXGI_FORMAT_BC7_UNORM_SRGB = 99;
+
+	struct DDSPixelFormat
+	{
+		unsigned int Size, Flags, FourCC, RGBBitCount, RBitMask, GBitMask, BBitMask, ABitMask;
+	};
+
+	struct DDSHeader
+	{
+		unsigned int Size, Flags, Height, Width, PitchOrLinearSize, Depth, MipMapCount;
+		unsigned int Reserved1[11];
+		DDSPixelFormat PixelFormat;
+		unsigned int Caps, Caps2, Caps3, Caps4, Reserved2;
+	};
+
+	struct DDSHeaderDX10
+	{
+		unsigned int DXGIFormat, ResourceDimension, MiscFlag, ArraySize, MiscFlags2;
+	};
+
+	struct KTXHeader
+	{
+		unsigned char Identifier[12];
+		unsigned int Endianness, GLType, GLTypeSize, GLFormat, GLInternalFormat, GLBaseInternalFormat;
+		unsigned int PixelWidth, PixelHeight, PixelDepth, NumberOfArrayElements, NumberOfFaces;
+		unsigned int NumberOfMipmapLevels, BytesOfKeyValueData;
+	};
+
+	static bool ReadFile(const std::string& path, std::vector<unsigned char>& data)
+	{
+		std::ifstream stream(path, std::ios::binary);
+		if (!stream)
+			return false;
+		data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	static bool EndsWith(const std::string& str, const char* suffix)
+	{
+		size_t length = strlen(suffix);
+		if (str.size() < length)
+			return false;
+		for (size_t i = 0; i < length; i++)
+		{
+			if (tolower(str[str.size() - length + i]) != suffix[i])
+				return false;
+		}
+		return true;
+	}
+
+	static unsigned int GetLevelSize(unsigned int format, int width, int height)
+	{
+		return (unsigned int)(std::max(1, (width + 3) / 4) * std::max(1, (height + 3) / 4)) * GetBlockSize(format);
+	}
+
+	bool IsCompressedFile(const std::string& path)
+	{
+		return EndsWith(path, ".dds") || EndsWith(path, ".ktx");
+	}
+
+	bool Load(const std::string& path, CompressedImage& image)
+	{
+		if (EndsWith(path, ".dds"))
+			return LoadDDS(path, image);
+		if (EndsWith(path, ".ktx"))
+			return LoadKTX(path, image);
+		return false;
+	}
+
+	unsigned int GetBlockSize(unsigned int format)
+	{
+		switch (format)
+		{
+			case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_RGB8_ETC2:
+			case GL_COMPRESSED_SRGB8_ETC2:
+			case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+				return 8;
+			case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			case GL_COMPRESSED_RGBA_BPTC_UNORM:
+			case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+			case GL_COMPRESSED_RGBA8_ETC2_EAC:
+			case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+				return 16;
+		}
+		return 0;
+	}
+
+	const char* GetFormatName(unsigned int format)
+	{
+		switch (format)
+		{
+			case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:            return "BC1";
+			case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:           return "BC1A";
+			case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:           return "BC3";
+			case GL_COMPRESSED_RGBA_BPTC_UNORM:              return "BC7";
+			case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:        return "BC7 sRGB";
+			case GL_COMPRESSED_RGB8_ETC2:                    return "ETC2 RGB";
+			case GL_COMPRESSED_SRGB8_ETC2:                   return "ETC2 sRGB";
+			case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2: return "ETC2 RGB A1";
+			case GL_COMPRESSED_RGBA8_ETC2_EAC:               return "ETC2 RGBA";
+			case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:        return "ETC2 sRGB A";
+		}
+		return "unknown";
+	}
+
+	bool IsFormatSupported(unsigned int format)
+	{
+		switch (format)
+		{
+			case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+				return GLEW_EXT_texture_compression_s3tc != 0;
+			case GL_COMPRESSED_RGBA_BPTC_UNORM:
+			case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+				return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+			case GL_COMPRESSED_RGB8_ETC2:
+			case GL_COMPRESSED_SRGB8_ETC2:
+			case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+			case GL_COMPRESSED_RGBA8_ETC2_EAC:
+			case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+				return GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility;
+		}
+		return false;
+	}
+
+	bool LoadDDS(const std::string& path, CompressedImage& image)
+	{
+		std::vector<unsigned char> file;
+		if (!ReadFile(path, file) || file.size() < 4 + sizeof(DDSHeader))
+			return false;
+
+		unsigned int magic;
+		DDSHeader header;
+		memcpy(&magic, &file[0], 4);
+		memcpy(&header, &file[4], sizeof(header));
+		if (magic != DDS_MAGIC || header.Size != sizeof(DDSHeader))
+		{
+			std::cout << "'" << path << "' is not a DDS file" << std::endl;
+			return false;
+		}
+
+		unsigned int offset = 4 + sizeof(DDSHeader);
+		unsigned int fourCC = header.PixelFormat.FourCC;
+		unsigned int dxgiFormat = 0;
+		if (fourCC == FOURCC_DX10)
+		{
+			if (file.size() < offset + sizeof(DDSHeaderDX10))
+				return false;
+			DDSHeaderDX10 dx10;
+			memcpy(&dx10, &file[offset], sizeof(dx10));
+			dxgiFormat = dx10.DXGIFormat;
+			offset += sizeof(DDSHeaderDX10);
+		}
+
+		if (fourCC == FOURCC_DXT1 || dxgiFormat == DXGI_FORMAT_BC1_UNORM)
+			image.Format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		else if (fourCC == FOURCC_DXT5 || dxgiFormat == DXGI_FORMAT_BC3_UNORM)
+			image.Format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		else if (dxgiFormat == DXGI_FORMAT_BC7_UNORM)
+			image.Format = GL_COMPRESSED_RGBA_BPTC_UNORM;
+		else if (dxgiFormat == DXGI_FORMAT_BC7_UNORM_SRGB)
+			image.Format = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+		else
+		{
+			std::cout << "'" << path << "' uses an unsupported DDS format" << std::endl;
+			return false;
+		}
+
+		image.Width = header.Width;
+		image.Height = header.Height;
+		image.Levels.clear();
+		unsigned int levels = std::max(1u, header.MipMapCount);
+		unsigned int dataOffset = offset;
+		unsigned int levelOffset = 0;
+		int width = image.Width, height = image.Height;
+		for (unsigned int level = 0; level < levels; level++)
+		{
+			unsigned int size = GetLevelSize(image.Format, width, height);
+			if (dataOffset + levelOffset + size > file.size())
+				break;
+			image.Levels.push_back({ width, height, levelOffset, size });
+			levelOffset += size;
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+		}
+		if (image.Levels.empty())
+			return false;
+
+		image.Data.assign(file.begin() + dataOffset, file.begin() + dataOffset + levelOffset);
+		return true;
+	}
+
+	bool LoadKTX(const std::string& path, CompressedImage& image)
+	{
+		static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+		std::vector<unsigned char> file;
+		if (!ReadFile(path, file) || file.size() < sizeof(KTXHeader))
+			return false;
+
+		KTXHeader header;
+		memcpy(&header, &file[0], sizeof(header));
+		if (memcmp(header.Identifier, identifier, sizeof(identifier)) != 0 || header.Endianness != 0x04030201)
+		{
+			std::cout << "'" << path << "' is not a little-endian KTX 1.1 file" << std::endl;
+			return false;
+		}
+		if (header.GLType != 0 || GetBlockSize(header.GLInternalFormat) == 0)
+		{
+			std::cout << "'" << path << "' is not block compressed" << std::endl;
+			return false;
+		}
+		if (header.NumberOfFaces > 1 || header.NumberOfArrayElements > 1 || header.PixelDepth > 1)
+		{
+			std::cout << "'" << path << "' is not a plain 2D texture" << std::endl;
+			return false;
+		}
+
+		image.Format = header.GLInternalFormat;
+		image.Width = header.PixelWidth;
+		image.Height = header.PixelHeight;
+		image.Levels.clear();
+		image.Data.clear();
+
+		size_t offset = sizeof(KTXHeader) + header.BytesOfKeyValueData;
+		unsigned int levels = std::max(1u, header.NumberOfMipmapLevels);
+		int width = image.Width, height = image.Height;
+		for (unsigned int level = 0; level < levels; level++)
+		{
+			if (offset + 4 > file.size())
+				break;
+			unsigned int size;
+			memcpy(&size, &file[offset], 4);
+			offset += 4;
+			if (offset + size > file.size() || size != GetLevelSize(image.Format, width, height))
+				break;
+
+			image.Levels.push_back({ width, height, (unsigned int)image.Data.size(), size });
+			image.Data.insert(image.Data.end(), file.begin() + offset, file.begin() + offset + size);
+			offset += (size + 3) & ~3u; // mipPadding
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+		}
+		return !image.Levels.empty();
+	}
+
+	bool WriteDDS(const std::string& path, const CompressedImage& image)
+	{
+		std::ofstream stream(path, std::ios::binary);
+		if (!stream)
+			return false;
+
+		DDSHeader header;
+		memset(&header, 0, sizeof(header));
+		header.Size = sizeof(DDSHeader);
+		header.Flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // CAPS, HEIGHT, WIDTH, PIXELFORMAT, MIPMAPCOUNT, LINEARSIZE
+		header.Height = image.Height;
+		header.Width = image.Width;
+		header.PitchOrLinearSize = image.Levels[0].Size;
+		header.MipMapCount = (unsigned int)image.Levels.size();
+		header.PixelFormat.Size = sizeof(DDSPixelFormat);
+		header.PixelFormat.Flags = 0x4; // FOURCC
+		header.PixelFormat.FourCC = image.Format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ? FOURCC_DXT5 : FOURCC_DXT1;
+		header.Caps = 0x1000 | 0x8 | 0x400000; // TEXTURE, COMPLEX, MIPMAP
+
+		stream.write((const char*)&DDS_MAGIC, 4);
+		stream.write((const char*)&header, sizeof(header));
+		stream.write((const char*)image.Data.data(), image.Data.size());
+		return (bool)stream;
+	}
+
+	// Encoder ----------------------------------------------------------------
+
+	static unsigned short ToRGB565(const unsigned char* c)
+	{
+		return (unsigned short)(((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3));
+	}
+
+	static void FromRGB565(unsigned short v, int* c)
+	{
+		c[0] = ((v >> 11) & 31) * 255 / 31;
+		c[1] = ((v >> 5) & 63) * 255 / 63;
+		c[2] = (v & 31) * 255 / 31;
+	}
+
+	// Endpoints from the colour bounding box, inset by 1/16 to cut the error
+	// from outliers; each texel then takes the closest of the four colours.
+	static void EncodeColorBlock(const unsigned char block[16][4], unsigned char* out)
+	{
+		unsigned char minColor[4] = { 255, 255, 255, 255 }, maxColor[4] = { 0, 0, 0, 0 };
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				minColor[c] = std::min(minColor[c], block[i][c]);
+				maxColor[c] = std::max(maxColor[c], block[i][c]);
+			}
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			int inset = (maxColor[c] - minColor[c]) / 16;
+			minColor[c] = (unsigned char)(minColor[c] + inset);
+			maxColor[c] = (unsigned char)(maxColor[c] - inset);
+		}
+
+		unsigned short c0 = ToRGB565(maxColor), c1 = ToRGB565(minColor);
+		if (c0 < c1)
+			std::swap(c0, c1);
+
+		int palette[4][3];
+		FromRGB565(c0, palette[0]);
+		FromRGB565(c1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		unsigned int indices = 0;
+		if (c0 != c1)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				int best = 0, bestDistance = 0x7FFFFFFF;
+				for (int p = 0; p < 4; p++)
+				{
+					int dr = block[i][0] - palette[p][0], dg = block[i][1] - palette[p][1], db = block[i][2] - palette[p][2];
+					int distance = dr * dr + dg * dg + db * db;
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						best = p;
+					}
+				}
+				indices |= (unsigned int)best << (2 * i);
+			}
+		}
+
+		out[0] = (unsigned char)(c0 & 0xFF);
+		out[1] = (unsigned char)(c0 >> 8);
+		out[2] = (unsigned char)(c1 & 0xFF);
+		out[3] = (unsigned char)(c1 >> 8);
+		memcpy(&out[4], &indices, 4);
+	}
+
+	static void EncodeAlphaBlock(const unsigned char block[16][4], unsigned char* out)
+	{
+		unsigned char a0 = 0, a1 = 255;
+		for (int i = 0; i < 16; i++)
+		{
+			a0 = std::max(a0, block[i][3]);
+			a1 = std::min(a1, block[i][3]);
+		}
+
+		int palette[8] = { a0, a1 };
+		for (int p = 1; p < 7; p++)
+			palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+
+		unsigned long long indices = 0;
+		if (a0 != a1)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				int best = 0, bestDistance = 256;
+				for (int p = 0; p < 8; p++)
+				{
+					int distance = abs(block[i][3] - palette[p]);
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						best = p;
+					}
+				}
+				indices |= (unsigned long long)best << (3 * i);
+			}
+		}
+
+		out[0] = a0;
+		out[1] = a1;
+		for (int i = 0; i < 6; i++)
+			out[2 + i] = (unsigned char)(indices >> (8 * i));
+	}
+
+	static void EncodeLevel(const unsigned char* pixels, int width, int height, bool withAlpha, unsigned char* out)
+	{
+		unsigned int blockSize = withAlpha ? 16 : 8;
+		for (int by = 0; by < height; by += 4)
+		{
+			for (int bx = 0; bx < width; bx += 4)
+			{
+				// Edge blocks repeat the last row/column.
+				unsigned char block[16][4];
+				for (int y = 0; y < 4; y++)
+				{
+					for (int x = 0; x < 4; x++)
+					{
+						int px = std::min(bx + x, width - 1), py = std::min(by + y, height - 1);
+						memcpy(block[y * 4 + x], &pixels[(py * width + px) * 4], 4);
+					}
+				}
+
+				if (withAlpha)
+				{
+					EncodeAlphaBlock(block, out);
+					EncodeColorBlock(block, out + 8);
+				}
+				else
+				{
+					EncodeColorBlock(block, out);
+				}
+				out += blockSize;
+			}
+		}
+	}
+
+	static void Downsample(const std::vector<unsigned char>& src, int width, int height, std::vector<unsigned char>& dst)
+	{
+		int dstWidth = std::max(1, width / 2), dstHeight = std::max(1, height / 2);
+		dst.resize((size_t)dstWidth * dstHeight * 4);
+		for (int y = 0; y < dstHeight; y++)
+		{
+			int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+			for (int x = 0; x < dstWidth; x++)
+			{
+				int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+				for (int c = 0; c < 4; c++)
+				{
+					int sum = src[(y0 * width + x0) * 4 + c] + src[(y0 * width + x1) * 4 + c]
+						+ src[(y1 * width + x0) * 4 + c] + src[(y1 * width + x1) * 4 + c];
+					dst[(y * dstWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	// Decoder, only to measure what the encoder lost -------------------------
+
+	static void DecodeColorBlock(const unsigned char* in, unsigned char block[16][4])
+	{
+		unsigned short c0 = (unsigned short)(in[0] | (in[1] << 8)), c1 = (unsigned short)(in[2] | (in[3] << 8));
+		int palette[4][3];
+		FromRGB565(c0, palette[0]);
+		FromRGB565(c1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			// c0 <= c1 is the three colour mode, with black as the fourth.
+			palette[2][c] = c0 > c1 ? (2 * palette[0][c] + palette[1][c]) / 3 : (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = c0 > c1 ? (palette[0][c] + 2 * palette[1][c]) / 3 : 0;
+		}
+
+		unsigned int indices;
+		memcpy(&indices, &in[4], 4);
+		for (int i = 0; i < 16; i++)
+		{
+			const int* color = palette[(indices >> (2 * i)) & 3];
+			for (int c = 0; c < 3; c++)
+				block[i][c] = (unsigned char)color[c];
+			block[i][3] = 255;
+		}
+	}
+
+	static void DecodeAlphaBlock(const unsigned char* in, unsigned char block[16][4])
+	{
+		int palette[8] = { in[0], in[1] };
+		if (in[0] > in[1])
+		{
+			for (int p = 1; p < 7; p++)
+				palette[p + 1] = ((7 - p) * in[0] + p * in[1]) / 7;
+		}
+		else
+		{
+			for (int p = 1; p < 5; p++)
+				palette[p + 1] = ((5 - p) * in[0] + p * in[1]) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		unsigned long long indices = 0;
+		for (int i = 0; i < 6; i++)
+			indices |= (unsigned long long)in[2 + i] << (8 * i);
+		for (int i = 0; i < 16; i++)
+			block[i][3] = (unsigned char)palette[(indices >> (3 * i)) & 7];
+	}
+
+	// PSNR of the top level against the source, over RGB, plus alpha for BC3.
+	static double GetPSNR(const unsigned char* pixels, const CompressedImage& image)
+	{
+		bool withAlpha = image.Format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		int width = image.Width, height = image.Height;
+		const unsigned char* in = &image.Data[image.Levels[0].Offset];
+		double error = 0.0;
+		for (int by = 0; by < height; by += 4)
+		{
+			for (int bx = 0; bx < width; bx += 4)
+			{
+				unsigned char block[16][4];
+				if (withAlpha)
+				{
+					DecodeColorBlock(in + 8, block);
+					DecodeAlphaBlock(in, block);
+				}
+				else
+				{
+					DecodeColorBlock(in, block);
+				}
+				in += withAlpha ? 16 : 8;
+
+				for (int y = 0; y < 4 && by + y < height; y++)
+				{
+					for (int x = 0; x < 4 && bx + x < width; x++)
+					{
+						const unsigned char* source = &pixels[((by + y) * width + bx + x) * 4];
+						for (int c = 0; c < (withAlpha ? 4 : 3); c++)
+						{
+							double difference = (double)source[c] - block[y * 4 + x][c];
+							error += difference * difference;
+						}
+					}
+				}
+			}
+		}
+
+		double mse = error / ((double)width * height * (withAlpha ? 4 : 3));
+		return 10.0 * std::log10(255.0 * 255.0 / mse); // Infinite when lossless
+	}
+
+	void Encode(const unsigned char* pixels, int width, int height, bool withAlpha, CompressedImage& image)
+	{
+		image.Format = withAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		image.Width = width;
+		image.Height = height;
+		image.Levels.clear();
+		image.Data.clear();
+
+		std::vector<unsigned char> level(pixels, pixels + (size_t)width * height * 4), next;
+		for (;;)
+		{
+			unsigned int size = GetLevelSize(image.Format, width, height);
+			image.Levels.push_back({ width, height, (unsigned int)image.Data.size(), size });
+			image.Data.resize(image.Data.size() + size);
+			EncodeLevel(level.data(), width, height, withAlpha, &image.Data[image.Levels.back().Offset]);
+
+			if (width == 1 && height == 1)
+				break;
+			Downsample(level, width, height, next);
+			level.swap(next);
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+		}
+	}
+
+	bool CompressFile(const std::string& inputPath, const std::string& outputPath)
+	{
+		int width, height, bpp;
+		stbi_set_flip_vertically_on_load(1);
+		unsigned char* pixels = stbi_load(inputPath.c_str(), &width, &height, &bpp, 4);
+		if (!pixels)
+		{
+			std::cout << "Failed to load '" << inputPath << "': " << stbi_failure_reason() << std::endl;
+			return false;
+		}
+
+		bool withAlpha = false;
+		for (int i = 0; i < width * height && !withAlpha; i++)
+			withAlpha = pixels[i * 4 + 3] != 255;
+
+		CompressedImage image;
+		Encode(pixels, width, height, withAlpha, image);
+		double psnr = GetPSNR(pixels, image);
+		stbi_image_free(pixels);
+		ImageArena::Reset();
+
+		std::string path = outputPath;
+		if (path.empty())
+		{
+			size_t dot = inputPath.find_last_of('.');
+			path = (dot == std::string::npos ? inputPath : inputPath.substr(0, dot)) + ".dds";
+		}
+		if (!WriteDDS(path, image))
+		{
+			std::cout << "Failed to write '" << path << "'" << std::endl;
+			return false;
+		}
+
+		std::cout << inputPath << " -> " << path << " (" << GetFormatName(image.Format) << ", "
+			<< image.Levels.size() << " levels, " << image.Data.size() / 1024 << " KB, PSNR " << psnr << " dB)" << std::endl;
+		return true;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// A block-compressed image with its mip chain, as stored in DDS/KTX files.
+struct CompressedImage
+{
+	struct Level
+	{
+		int Width, Height;
+		unsigned int Offset, Size; // Into Data
+	};
+
+	unsigned int Format; // GL_COMPRESSED_* internal format
+	int Width, Height;
+	std::vector<Level> Levels;
+	std::vector<unsigned char> Data;
+};
+
+// Loading and encoding of GPU-compressed textures: BC1/BC3/BC7 in DDS and
+// BC1/BC3/BC7/ETC2 in KTX 1.1 containers. The encoder writes BC1 (opaque) or
+// BC3 (with alpha) DDS files from anything stb_image reads.
+//
+// Rows are kept bottom to top, the way Texture loads PNGs, so DDS files made
+// by CompressFile show up the right way. Files from other tools (top to
+// bottom) appear flipped unless they were exported flipped.
+namespace TextureCompression
+{
+	bool IsCompressedFile(const std::string& path);
+	bool Load(const std::string& path, CompressedImage& image);
+	bool LoadDDS(const std::string& path, CompressedImage& image);
+	bool LoadKTX(const std::string& path, CompressedImage& image);
+	bool WriteDDS(const std::string& path, const CompressedImage& image);
+
+	unsigned int GetBlockSize(unsigned int format);
+	const char* GetFormatName(unsigned int format);
+	bool IsFormatSupported(unsigned int format);
+
+	// RGBA8 in, full mip chain of BC1 (or BC3 when withAlpha) out.
+	void Encode(const unsigned char* pixels, int width, int height, bool withAlpha, CompressedImage& image);
+
+	// Offline tool: converts an image to a .dds next to it (or to outputPath).
+	bool CompressFile(const std::string& inputPath, const std::string& outputPath = "");
+}
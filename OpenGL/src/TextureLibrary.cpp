@@ -0,0 +1,160 @@
+#include "TextureLibrary.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "Hash.h"
+#include "Texture.h"
+
+static std::string NormalizePath(const std::string& path)
+{
+	std::string result = path;
+	std::replace(result.begin(), result.end(), '\\', '/');
+	while (result.compare(0, 2, "./") == 0)
+		result.erase(0, 2);
+	for (size_t pos; (pos = result.find("/./")) != std::string::npos;)
+		result.erase(pos, 2);
+	return result;
+}
+
+static bool HashFile(const std::string& path, unsigned long long& hash)
+{
+	std::ifstream stream(path, std::ios::binary);
+	if (!stream)
+		return false;
+
+	char buffer[64 * 1024];
+	hash = HASH_SEED;
+	while (stream.read(buffer, sizeof(buffer)) || stream.gcount() > 0)
+		hash = HashBytes(buffer, (size_t)stream.gcount(), hash);
+	return true;
+}
+
+TextureLibrary::TextureLibrary(size_t budgetBytes)
+	: m_Budget(budgetBytes)
+{
+}
+
+std::shared_ptr<Texture> TextureLibrary::Acquire(Entry& entry)
+{
+	std::shared_ptr<Texture> handle = entry.Handle.lock();
+	if (handle)
+		return handle;
+
+	// The deleter keeps the texture alive, so handles may outlive the library.
+	std::shared_ptr<Texture> resource = entry.Resource;
+	std::shared_ptr<Clock::time_point> lastUsed = entry.LastUsed;
+	handle = std::shared_ptr<Texture>(resource.get(), [resource, lastUsed](Texture*) { *lastUsed = Clock::now(); });
+	entry.Handle = handle;
+	return handle;
+}
+
+std::shared_ptr<Texture> TextureLibrary::Load(const std::string& path)
+{
+	std::string key = NormalizePath(path);
+	auto alias = m_Aliases.find(key);
+	if (alias != m_Aliases.end())
+		key = alias->second;
+
+	auto it = m_Entries.find(key);
+	if (it != m_Entries.end())
+		return Acquire(it->second);
+
+	// Reading the file is much cheaper than decoding and uploading it again.
+	unsigned long long hash = 0;
+	bool hashed = HashFile(key, hash);
+	if (hashed)
+	{
+		auto same = m_Contents.find(hash);
+		if (same != m_Contents.end())
+		{
+			m_Aliases[key] = same->second;
+			return Acquire(m_Entries[same->second]);
+		}
+	}
+
+	Entry& entry = m_Entries[key];
+	entry.Resource = std::make_shared<Texture>(key);
+	entry.LastUsed = std::make_shared<Clock::time_point>(Clock::now());
+	entry.ContentHash = hash;
+	if (hashed)
+		m_Contents[hash] = key;
+
+	// Held before trimming, so the new texture can't be the one to go.
+	std::shared_ptr<Texture> texture = Acquire(entry);
+	Trim();
+	return texture;
+}
+
+void TextureLibrary::SetBudget(size_t budgetBytes)
+{
+	m_Budget = budgetBytes;
+	Trim();
+}
+
+size_t TextureLibrary::GetGPUMemory() const
+{
+	size_t total = 0;
+	for (const auto& entry : m_Entries)
+		total += entry.second.Resource->GetGPUMemory();
+	return total;
+}
+
+void TextureLibrary::Trim()
+{
+	size_t used = GetGPUMemory();
+	if (used <= m_Budget)
+		return;
+
+	// Only textures held by nobody but us can go.
+	std::vector<std::pair<Clock::time_point, std::string>> unused;
+	for (const auto& entry : m_Entries)
+	{
+		if (entry.second.Handle.expired())
+			unused.push_back({ *entry.second.LastUsed, entry.first });
+	}
+	std::sort(unused.begin(), unused.end());
+
+	for (const auto& candidate : unused)
+	{
+		if (used <= m_Budget)
+			break;
+		used -= m_Entries[candidate.second].Resource->GetGPUMemory();
+		Evict(candidate.second);
+	}
+
+	if (used > m_Budget)
+		std::cout << "Warning: textures in use take " << used / (1024 * 1024) << " MB, over the "
+			<< m_Budget / (1024 * 1024) << " MB budget" << std::endl;
+}
+
+void TextureLibrary::Clear()
+{
+	std::vector<std::string> unused;
+	for (const auto& entry : m_Entries)
+	{
+		if (entry.second.Handle.expired())
+			unused.push_back(entry.first);
+	}
+	for (const std::string& key : unused)
+		Evict(key);
+}
+
+void TextureLibrary::Evict(const std::string& key)
+{
+	auto it = m_Entries.find(key);
+	auto content = m_Contents.find(it->second.ContentHash);
+	if (content != m_Contents.end() && content->second == key)
+		m_Contents.erase(content);
+
+	for (auto alias = m_Aliases.begin(); alias != m_Aliases.end();)
+	{
+		if (alias->second == key)
+			alias = m_Aliases.erase(alias);
+		else
+			++alias;
+	}
+	m_Entries.erase(it);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+class Texture;
+
+// Shares textures between everyone who loads the same image. Paths are
+// normalised and file contents hashed, so a copy of an image under another
+// name is not uploaded twice either. Callers hold the returned shared_ptr;
+// textures nobody holds anymore stay cached until the memory budget is
+// exceeded, then the least recently used ones are deleted first: the ones
+// whose last holder let go of them longest ago. The budget is enforced by
+// Load, SetBudget and Trim.
+class TextureLibrary
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Entry
+	{
+		std::shared_ptr<Texture> Resource;
+		// What callers hold: shares the texture, and stamps LastUsed when
+		// the last copy goes away. Expired while nobody uses the texture.
+		std::weak_ptr<Texture> Handle;
+		std::shared_ptr<Clock::time_point> LastUsed;
+		unsigned long long ContentHash;
+	};
+
+	std::unordered_map<std::string, Entry> m_Entries;            // normalised path -> entry
+	std::unordered_map<unsigned long long, std::string> m_Contents; // content hash -> key in m_Entries
+	std::unordered_map<std::string, std::string> m_Aliases;       // other paths with the same content
+	size_t m_Budget;
+public:
+	TextureLibrary(size_t budgetBytes = 256 * 1024 * 1024);
+
+	std::shared_ptr<Texture> Load(const std::string& path);
+
+	void SetBudget(size_t budgetBytes);
+	// Deletes unused textures, least recently used first, until under budget.
+	void Trim();
+	// Deletes every texture nobody holds.
+	void Clear();
+
+	size_t GetGPUMemory() const;
+	inline unsigned int GetCount() const { return (unsigned int)m_Entries.size(); }
+	inline size_t GetBudget() const { return m_Budget; }
+private:
+	static std::shared_ptr<Texture> Acquire(Entry& entry);
+	void Evict(const std::string& key);
+};
@@ -0,0 +1,203 @@
+#include "TextureLoader.h"
+
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include "Texture.h"
+#include "vendor\stb_image\stb_image.h"
+
+TextureLoader::TextureLoader(unsigned int threads)
+	: m_Decoding(0), m_Quit(false), m_PixelBuffers{ 0, 0 }, m_PixelBufferSizes{ 0, 0 }, m_NextPixelBuffer(0)
+{
+	if (threads == 0)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		threads = cores > 1 ? cores - 1 : 1;
+	}
+
+	// The flag is global in stb_image, set it once before any worker decodes.
+	stbi_set_flip_vertically_on_load(1);
+
+	for (unsigned int i = 0; i < threads; i++)
+		m_Workers.emplace_back(&TextureLoader::WorkerLoop, this);
+
+	GLCall(glGenBuffers(2, m_PixelBuffers));
+}
+
+TextureLoader::~TextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Quit = true;
+	}
+	m_Condition.notify_all();
+	for (std::thread& worker : m_Workers)
+		worker.join();
+
+	GLCall(glDeleteBuffers(2, m_PixelBuffers));
+}
+
+std::shared_ptr<Texture> TextureLoader::Load(const std::string& path)
+{
+	std::shared_ptr<Texture> texture(new Texture());
+	texture->m_FilePath = path;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Requests.push_back({ texture, path });
+	}
+	m_Condition.notify_one();
+	return texture;
+}
+
+void TextureLoader::WorkerLoop()
+{
+	for (;;)
+	{
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this] { return m_Quit || !m_Requests.empty(); });
+			if (m_Quit)
+				return;
+			request = m_Requests.front();
+			m_Requests.pop_front();
+			m_Decoding++;
+		}
+
+		DecodedImage image = { request.Target, request.Path, {}, 0, 0, 0, { 0, 0, 0 } };
+		// Nobody is waiting for it anymore, don't bother decoding.
+		if (!request.Target.expired())
+		{
+			unsigned char* pixels = stbi_load(request.Path.c_str(), &image.Width, &image.Height, &image.BPP, 0);
+			if (pixels)
+			{
+				// The arena is reset below, before the GL thread gets to upload.
+				size_t size = (size_t)image.Width * image.Height * image.BPP;
+				image.Pixels = TakeStaging(size);
+				memcpy(image.Pixels.data(), pixels, size);
+			}
+			else
+				std::cout << "Failed to load texture '" << request.Path << "': " << stbi_failure_reason() << std::endl;
+			stbi_image_free(pixels);
+			image.DecodeStats = ImageArena::Reset();
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Decoding--;
+		if (!image.Pixels.empty())
+			m_Decoded.push_back(std::move(image));
+	}
+}
+
+void TextureLoader::Update(unsigned int budgetBytes)
+{
+	unsigned int uploaded = 0;
+	while (uploaded < budgetBytes)
+	{
+		DecodedImage image;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_Decoded.empty())
+				break;
+			image = std::move(m_Decoded.front());
+			m_Decoded.pop_front();
+		}
+
+		if (!image.Target.expired())
+		{
+			Upload(image);
+			uploaded += image.Width * image.Height * image.BPP;
+		}
+		ReturnStaging(image.Pixels);
+	}
+}
+
+std::vector<unsigned char> TextureLoader::TakeStaging(size_t size)
+{
+	std::vector<unsigned char> buffer;
+	{
+		// The smallest that fits, or else the largest, which grows the least.
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		int best = -1;
+		for (int i = 0; i < (int)m_Staging.size(); i++)
+		{
+			if (m_Staging[i].size() >= size && (best < 0 || m_Staging[i].size() < m_Staging[best].size()))
+				best = i;
+		}
+		if (best < 0)
+		{
+			for (int i = 0; i < (int)m_Staging.size(); i++)
+			{
+				if (best < 0 || m_Staging[i].size() > m_Staging[best].size())
+					best = i;
+			}
+		}
+		if (best >= 0)
+		{
+			std::swap(m_Staging[best], m_Staging.back());
+			buffer = std::move(m_Staging.back());
+			m_Staging.pop_back();
+		}
+	}
+	// Buffers only ever grow, so a reused one is never cleared or zeroed.
+	if (buffer.size() < size)
+		buffer.resize(size);
+	return buffer;
+}
+
+void TextureLoader::ReturnStaging(std::vector<unsigned char>& buffer)
+{
+	if (buffer.empty())
+		return;
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Staging.size() < MaxStagingBuffers)
+		m_Staging.push_back(std::move(buffer));
+}
+
+void TextureLoader::Upload(const DecodedImage& image)
+{
+	unsigned int size = image.Width * image.Height * image.BPP;
+	unsigned int buffer = m_NextPixelBuffer;
+	m_NextPixelBuffer = (m_NextPixelBuffer + 1) % 2;
+
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PixelBuffers[buffer]));
+	// Re-specifying the store orphans the old one instead of waiting for the
+	// driver to finish reading it.
+	if (size > m_PixelBufferSizes[buffer])
+		m_PixelBufferSizes[buffer] = size;
+	GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, m_PixelBufferSizes[buffer], nullptr, GL_STREAM_DRAW));
+	GLCall(void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+	unsigned int rendererID;
+	if (dst)
+	{
+		memcpy(dst, image.Pixels.data(), size);
+		GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+		rendererID = Texture::CreateTexture(image.Width, image.Height, nullptr, image.BPP);
+		GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	}
+	else
+	{
+		// Mapping failed, upload straight from our memory instead.
+		GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+		rendererID = Texture::CreateTexture(image.Width, image.Height, image.Pixels.data(), image.BPP);
+	}
+
+	std::shared_ptr<Texture> texture = image.Target.lock();
+	if (texture)
+	{
+		texture->SetImage(rendererID, image.Width, image.Height, image.BPP);
+		texture->m_DecodeStats = image.DecodeStats;
+	}
+	else
+	{
+		GLCall(glDeleteTextures(1, &rendererID));
+	}
+}
+
+unsigned int TextureLoader::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return (unsigned int)(m_Requests.size() + m_Decoding + m_Decoded.size());
+}
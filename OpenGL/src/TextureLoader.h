@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ImageArena.h"
+
+class Texture;
+
+// Loads textures without blocking the GL thread. Images are decoded with
+// stb_image on worker threads and moved out of the worker's ImageArena into a
+// staging buffer taken from a small pool, so loading doesn't allocate once the
+// pool has grown to the size of the images. Update() then copies them into a
+// pixel unpack buffer and uploads from there, stopping once the frame's byte
+// budget is spent, and hands the staging buffers back. Until then Load() hands
+// back a 1x1 white placeholder.
+class TextureLoader
+{
+private:
+	struct Request
+	{
+		std::weak_ptr<Texture> Target;
+		std::string Path;
+	};
+
+	struct DecodedImage
+	{
+		std::weak_ptr<Texture> Target;
+		std::string Path;
+		std::vector<unsigned char> Pixels; // Staging buffer, may be larger than the image
+		int Width, Height, BPP;
+		ImageArenaStats DecodeStats;
+	};
+
+	std::vector<std::thread> m_Workers;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::deque<Request> m_Requests;
+	std::deque<DecodedImage> m_Decoded;
+	unsigned int m_Decoding;
+	bool m_Quit;
+	std::vector<std::vector<unsigned char>> m_Staging; // Spare staging buffers
+
+	// Two buffers so the driver can still be reading one while we fill the other.
+	unsigned int m_PixelBuffers[2];
+	unsigned int m_PixelBufferSizes[2];
+	unsigned int m_NextPixelBuffer;
+public:
+	TextureLoader(unsigned int threads = 0); // 0 picks one per core, minus the GL thread
+	~TextureLoader();
+
+	std::shared_ptr<Texture> Load(const std::string& path);
+
+	// Call once per frame on the GL thread. At least one image is uploaded per
+	// call so a single large texture can't starve.
+	void Update(unsigned int budgetBytes = 8 * 1024 * 1024);
+
+	unsigned int GetPendingCount();
+private:
+	void WorkerLoop();
+	void Upload(const DecodedImage& image);
+	// Both lock m_Mutex.
+	std::vector<unsigned char> TakeStaging(size_t size);
+	void ReturnStaging(std::vector<unsigned char>& buffer);
+
+	static const unsigned int MaxStagingBuffers = 4;
+};
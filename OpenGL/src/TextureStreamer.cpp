@@ -0,0 +1,379 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <queue>
+
+#include "Texture.h"
+#include "vendor\stb_image\stb_image.h"
+
+TextureStreamer::TextureStreamer(JobSystem& jobs, size_t residencyBudget)
+	: m_Jobs(jobs), m_Quit(false), m_NextID(1), m_ResidencyBudget(residencyBudget), m_ResidentBytes(0)
+{
+	// The flag is global in stb_image, set it once before any job decodes.
+	stbi_set_flip_vertically_on_load(1);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	m_Quit = true;
+	m_Jobs.Wait(m_Decoding);
+}
+
+std::shared_ptr<Texture> TextureStreamer::Load(const std::string& path)
+{
+	std::shared_ptr<Texture> texture(new Texture());
+	texture->m_FilePath = path;
+
+	unsigned int id = m_NextID++;
+	StreamedTexture& entry = m_Textures[id];
+	entry.Target = texture;
+	entry.Path = path;
+	entry.Channels = 4;
+	entry.TailLevel = 0;
+	entry.ResidentLevel = 0;
+	entry.WantedLevel = 0;
+	entry.ScreenSize = -1.0f;
+	entry.Decoded = false;
+	entry.ReloadFailed = false;
+	m_IDs[texture.get()] = id;
+
+	StartDecode(id, entry);
+	return texture;
+}
+
+void TextureStreamer::StartDecode(unsigned int id, StreamedTexture& texture)
+{
+	texture.Decoding = true;
+	std::weak_ptr<Texture> target = texture.Target;
+	std::string path = texture.Path;
+	// Background: a frame's ParallelFor must not end up running a decode.
+	m_Jobs.RunBackground(m_Decoding, [this, id, target, path] { Decode(id, target, path); });
+}
+
+void TextureStreamer::SetScreenSize(const std::shared_ptr<Texture>& texture, float pixels)
+{
+	auto id = m_IDs.find(texture.get());
+	if (id == m_IDs.end())
+		return;
+	m_Textures[id->second].ScreenSize = pixels;
+}
+
+void TextureStreamer::SetResidencyBudget(size_t bytes)
+{
+	m_ResidencyBudget = bytes;
+}
+
+void TextureStreamer::Decode(unsigned int id, const std::weak_ptr<Texture>& target, const std::string& path)
+{
+	if (m_Quit)
+		return;
+
+	DecodedImage image;
+	image.ID = id;
+	image.Channels = 0;
+	image.DecodeStats = { 0, 0, 0 };
+	// Nobody is waiting for it anymore, don't bother decoding.
+	if (!target.expired())
+	{
+		int width, height, bpp;
+		unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &bpp, 0);
+		if (pixels)
+		{
+			image.Levels = BuildMipChain(pixels, width, height, bpp, image.Pixels);
+			image.Channels = bpp;
+			stbi_image_free(pixels);
+		}
+		else
+		{
+			std::cout << "Failed to load texture '" << path << "': " << stbi_failure_reason() << std::endl;
+		}
+		image.DecodeStats = ImageArena::Reset();
+	}
+
+	// Failures are handed back too, so Update can stop waiting for them.
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Decoded.push_back(std::move(image));
+}
+
+std::vector<TextureStreamer::Level> TextureStreamer::BuildMipChain(const unsigned char* pixels, int width, int height, int channels, std::vector<unsigned char>& chain)
+{
+	std::vector<Level> levels(Texture::GetMipLevelCount(width, height));
+	size_t size = 0;
+	for (Level& level : levels)
+	{
+		level = { width, height, size, (size_t)width * height * channels };
+		size += level.Size;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	chain.resize(size);
+	memcpy(chain.data(), pixels, levels[0].Size);
+
+	// 2x2 box filter; a source side of odd length repeats its last row/column.
+	for (size_t i = 1; i < levels.size(); i++)
+	{
+		const Level& src = levels[i - 1];
+		const Level& dst = levels[i];
+		const unsigned char* in = &chain[src.Offset];
+		unsigned char* out = &chain[dst.Offset];
+		for (int y = 0; y < dst.Height; y++)
+		{
+			int y0 = std::min(y * 2, src.Height - 1), y1 = std::min(y * 2 + 1, src.Height - 1);
+			for (int x = 0; x < dst.Width; x++)
+			{
+				int x0 = std::min(x * 2, src.Width - 1), x1 = std::min(x * 2 + 1, src.Width - 1);
+				for (int c = 0; c < channels; c++)
+				{
+					int sum = in[(y0 * src.Width + x0) * channels + c] + in[(y0 * src.Width + x1) * channels + c]
+						+ in[(y1 * src.Width + x0) * channels + c] + in[(y1 * src.Width + x1) * channels + c];
+					out[(y * dst.Width + x) * channels + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+	return levels;
+}
+
+void TextureStreamer::Update(unsigned int budgetBytes)
+{
+	// Take over what the workers finished.
+	for (;;)
+	{
+		DecodedImage image;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_Decoded.empty())
+				break;
+			image = std::move(m_Decoded.front());
+			m_Decoded.pop_front();
+		}
+
+		auto it = m_Textures.find(image.ID);
+		if (it == m_Textures.end())
+			continue;
+		it->second.Decoding = false;
+		std::shared_ptr<Texture> target = it->second.Target.lock();
+		if (it->second.Decoded)
+		{
+			// Decoded again for levels that were evicted after the CPU copy
+			// was dropped. The file may have changed size in the meantime.
+			// Expired textures are dropped below with their resident bytes.
+			StreamedTexture& texture = it->second;
+			if (!target)
+				continue;
+			if (image.Levels.size() == texture.Levels.size() && image.Channels == texture.Channels
+				&& image.Levels[0].Width == texture.Levels[0].Width && image.Levels[0].Height == texture.Levels[0].Height)
+			{
+				texture.Pixels = std::move(image.Pixels);
+			}
+			else
+			{
+				std::cout << "Warning: '" << texture.Path << "' can't be reloaded, keeping its resident levels" << std::endl;
+				texture.ReloadFailed = true;
+			}
+			continue;
+		}
+		if (!target || image.Levels.empty())
+		{
+			// A texture that failed to load keeps showing the placeholder.
+			m_Textures.erase(it);
+			if (target)
+				m_IDs.erase(target.get());
+			continue;
+		}
+
+		StreamedTexture& texture = it->second;
+		texture.Levels = std::move(image.Levels);
+		texture.Pixels = std::move(image.Pixels);
+		texture.Channels = image.Channels;
+		texture.Decoded = true;
+		target->m_DecodeStats = image.DecodeStats;
+		Create(texture, *target);
+	}
+
+	// Drop textures nobody holds anymore; the Texture destructor already
+	// deleted the GL object.
+	for (auto it = m_Textures.begin(); it != m_Textures.end();)
+	{
+		if (!it->second.Target.expired())
+		{
+			++it;
+			continue;
+		}
+
+		const StreamedTexture& texture = it->second;
+		for (size_t level = texture.ResidentLevel; texture.Decoded && level < texture.Levels.size(); level++)
+			m_ResidentBytes -= texture.Levels[level].Size;
+		for (auto id = m_IDs.begin(); id != m_IDs.end(); ++id)
+		{
+			if (id->second == it->first)
+			{
+				m_IDs.erase(id);
+				break;
+			}
+		}
+		it = m_Textures.erase(it);
+	}
+
+	// The level whose size is closest to, but not below, the on-screen size.
+	for (auto& it : m_Textures)
+	{
+		StreamedTexture& texture = it.second;
+		if (!texture.Decoded)
+			continue;
+
+		texture.WantedLevel = 0;
+		if (texture.ScreenSize > 0.0f)
+		{
+			float size = (float)std::max(texture.Levels[0].Width, texture.Levels[0].Height);
+			texture.WantedLevel = (int)std::floor(std::log2(std::max(size / texture.ScreenSize, 1.0f)));
+		}
+		texture.WantedLevel = std::min(texture.WantedLevel, texture.TailLevel);
+
+		if (texture.ResidentLevel > texture.WantedLevel && texture.Pixels.empty() && !texture.Decoding && !texture.ReloadFailed)
+			StartDecode(it.first, texture);
+	}
+
+	// Over budget: free detail nobody is close enough to see, from the
+	// textures that have the most of it.
+	while (m_ResidentBytes > m_ResidencyBudget)
+	{
+		StreamedTexture* victim = nullptr;
+		int surplus = 0;
+		for (auto& it : m_Textures)
+		{
+			StreamedTexture& texture = it.second;
+			if (texture.Decoded && texture.WantedLevel - texture.ResidentLevel > surplus)
+			{
+				victim = &texture;
+				surplus = texture.WantedLevel - texture.ResidentLevel;
+			}
+		}
+		if (!victim)
+			break;
+		EvictLevel(*victim, *victim->Target.lock());
+	}
+
+	// Most levels missing first, then the largest on screen.
+	typedef std::pair<std::pair<int, float>, StreamedTexture*> Priority;
+	auto compare = [](const Priority& a, const Priority& b) { return a.first < b.first; };
+	std::priority_queue<Priority, std::vector<Priority>, decltype(compare)> queue(compare);
+	for (auto& it : m_Textures)
+	{
+		StreamedTexture& texture = it.second;
+		if (texture.Decoded && texture.ResidentLevel > texture.WantedLevel && !texture.Pixels.empty())
+			queue.push({ { texture.ResidentLevel - texture.WantedLevel, texture.ScreenSize }, &texture });
+	}
+
+	unsigned int uploaded = 0;
+	while (!queue.empty() && uploaded < budgetBytes)
+	{
+		StreamedTexture& texture = *queue.top().second;
+		queue.pop();
+
+		int level = texture.ResidentLevel - 1;
+		size_t size = texture.Levels[level].Size;
+		if (m_ResidentBytes + size > m_ResidencyBudget)
+			continue;
+
+		UploadLevel(texture, *texture.Target.lock(), level);
+		uploaded += (unsigned int)size;
+		if (texture.ResidentLevel > texture.WantedLevel)
+			queue.push({ { texture.ResidentLevel - texture.WantedLevel, texture.ScreenSize }, &texture });
+	}
+
+	// Everything wanted is on the GPU, the CPU copy is only dead weight now.
+	for (auto& it : m_Textures)
+	{
+		StreamedTexture& texture = it.second;
+		if (texture.Decoded && texture.ResidentLevel <= texture.WantedLevel && !texture.Pixels.empty())
+			std::vector<unsigned char>().swap(texture.Pixels);
+	}
+}
+
+void TextureStreamer::Create(StreamedTexture& texture, Texture& target)
+{
+	int levels = (int)texture.Levels.size();
+	texture.TailLevel = levels - 1;
+	while (texture.TailLevel > 0 && std::max(texture.Levels[texture.TailLevel - 1].Width, texture.Levels[texture.TailLevel - 1].Height) <= TailSize)
+		texture.TailLevel--;
+
+	// Mutable storage: immutable storage would allocate every level up front,
+	// which is exactly what streaming is meant to avoid.
+	unsigned int rendererID;
+	GLCall(glGenTextures(1, &rendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D, rendererID));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1));
+	Texture::SetSwizzle(texture.Channels);
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+
+	GLCall(glDeleteTextures(1, &target.m_RendererID));
+	target.m_RendererID = rendererID;
+	target.m_Width = texture.Levels[0].Width;
+	target.m_Height = texture.Levels[0].Height;
+	target.m_BPP = texture.Channels;
+	target.SetGPUMemory(Texture::GetFormat(texture.Channels), 0);
+	target.m_Loaded = true;
+
+	texture.ResidentLevel = levels;
+	for (int level = levels - 1; level >= texture.TailLevel; level--)
+		UploadLevel(texture, target, level);
+}
+
+void TextureStreamer::UploadLevel(StreamedTexture& texture, Texture& target, int level)
+{
+	const Level& data = texture.Levels[level];
+	GLCall(glBindTexture(GL_TEXTURE_2D, target.m_RendererID));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, level, Texture::GetFormat(texture.Channels), data.Width, data.Height, 0,
+		Texture::GetPixelFormat(texture.Channels), GL_UNSIGNED_BYTE, &texture.Pixels[data.Offset]));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+
+	texture.ResidentLevel = level;
+	SetBaseLevel(texture, target);
+	m_ResidentBytes += data.Size;
+	target.SetGPUMemory(target.m_Format, target.m_GPUMemory + (unsigned int)data.Size);
+}
+
+void TextureStreamer::EvictLevel(StreamedTexture& texture, Texture& target)
+{
+	int level = texture.ResidentLevel++;
+	SetBaseLevel(texture, target);
+
+	// Respecifying the level as empty releases its storage.
+	GLCall(glBindTexture(GL_TEXTURE_2D, target.m_RendererID));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, level, Texture::GetFormat(texture.Channels), 0, 0, 0,
+		Texture::GetPixelFormat(texture.Channels), GL_UNSIGNED_BYTE, nullptr));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+
+	m_ResidentBytes -= texture.Levels[level].Size;
+	target.SetGPUMemory(target.m_Format, target.m_GPUMemory - (unsigned int)texture.Levels[level].Size);
+}
+
+void TextureStreamer::SetBaseLevel(const StreamedTexture& texture, Texture& target)
+{
+	// MIN_LOD would do the same clamping, but it is sampler state and the
+	// Sampler bound with the texture overrides it; BASE_LEVEL is not.
+	GLCall(glBindTexture(GL_TEXTURE_2D, target.m_RendererID));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, texture.ResidentLevel));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+unsigned int TextureStreamer::GetPendingCount()
+{
+	unsigned int pending = 0;
+	for (const auto& it : m_Textures)
+	{
+		const StreamedTexture& texture = it.second;
+		if (!texture.Decoded)
+			pending++;
+		else if (texture.ResidentLevel > texture.WantedLevel && !texture.ReloadFailed)
+			pending += texture.ResidentLevel - texture.WantedLevel;
+	}
+	return pending;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ImageArena.h"
+#include "JobSystem.h"
+
+class Texture;
+
+// Streams mip levels of large textures in, coarsest first. Jobs decode the
+// image and build its mip chain on the CPU; Update() then uploads the small
+// tail at once so the texture is usable right away, and adds finer levels one
+// at a time as the on-screen size reported with SetScreenSize asks for them.
+// GL_TEXTURE_BASE_LEVEL keeps sampling inside the levels that are resident.
+//
+// Levels above the residency budget are freed again, starting with textures
+// that are drawn smaller than their resident detail. The CPU copy of the
+// chain is dropped once every wanted level is resident; when a texture later
+// needs a finer level than the GPU has, the image is decoded again.
+class TextureStreamer
+{
+private:
+	struct Level
+	{
+		int Width, Height;
+		size_t Offset, Size;
+	};
+
+	struct StreamedTexture
+	{
+		std::weak_ptr<Texture> Target;
+		std::string Path;
+		std::vector<Level> Levels;
+		std::vector<unsigned char> Pixels; // Every level back to back, empty once resident
+		int Channels;
+		int TailLevel;     // Finest level of the tail, which is never evicted
+		int ResidentLevel; // Finest level on the GPU, Levels.size() while none is
+		int WantedLevel;
+		float ScreenSize;
+		bool Decoded;      // Levels is known and the GL texture exists
+		bool Decoding;     // A decode job is on its way
+		bool ReloadFailed; // The file couldn't be decoded again, stay as is
+	};
+
+	struct DecodedImage
+	{
+		unsigned int ID;
+		std::vector<Level> Levels;
+		std::vector<unsigned char> Pixels;
+		int Channels;
+		ImageArenaStats DecodeStats;
+	};
+
+	JobSystem& m_Jobs;
+	JobCounter m_Decoding;
+	std::mutex m_Mutex;
+	std::deque<DecodedImage> m_Decoded;
+	std::atomic<bool> m_Quit;
+
+	// Only touched on the GL thread. Keyed by ID rather than by the Texture's
+	// address, which a new texture can reuse before the old entry is dropped.
+	std::unordered_map<unsigned int, StreamedTexture> m_Textures;
+	std::unordered_map<const Texture*, unsigned int> m_IDs;
+	unsigned int m_NextID;
+	size_t m_ResidencyBudget;
+	size_t m_ResidentBytes;
+public:
+	TextureStreamer(JobSystem& jobs, size_t residencyBudget = 256 * 1024 * 1024);
+	~TextureStreamer(); // Waits for decodes already running, skips the rest
+
+	std::shared_ptr<Texture> Load(const std::string& path);
+
+	// Largest side of the texture as drawn, in pixels. Textures never given a
+	// size stream in up to full resolution.
+	void SetScreenSize(const std::shared_ptr<Texture>& texture, float pixels);
+
+	// Call once per frame on the GL thread. Levels are uploaded in priority
+	// order (most levels missing first) until the byte budget is spent.
+	void Update(unsigned int budgetBytes = 8 * 1024 * 1024);
+
+	void SetResidencyBudget(size_t bytes);
+	inline size_t GetResidencyBudget() const { return m_ResidencyBudget; }
+	inline size_t GetResidentBytes() const { return m_ResidentBytes; }
+	// Images still being decoded plus levels still to upload. GL thread only.
+	unsigned int GetPendingCount();
+
+	// Mip levels up to this size are uploaded together on the first Update.
+	static const int TailSize = 64;
+private:
+	void StartDecode(unsigned int id, StreamedTexture& texture);
+	void Decode(unsigned int id, const std::weak_ptr<Texture>& target, const std::string& path);
+	void Create(StreamedTexture& texture, Texture& target);
+	void UploadLevel(StreamedTexture& texture, Texture& target, int level);
+	void EvictLevel(StreamedTexture& texture, Texture& target);
+	void SetBaseLevel(const StreamedTexture& texture, Texture& target);
+	static std::vector<Level> BuildMipChain(const unsigned char* pixels, int width, int height, int channels, std::vector<unsigned char>& chain);
+};
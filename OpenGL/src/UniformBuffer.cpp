@@ -0,0 +1,139 @@
+#include "UniformBuffer.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "Renderer.h"
+#include "Shader.h"
+
+UniformBuffer::UniformBuffer(const Shader& shader, const char* block)
+	: m_RendererID(0), m_Shader(shader), m_BlockName(block), m_LinkCount(0), m_Dirty(false)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	Repack();
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+void UniformBuffer::Set(const char* member, const float* values, unsigned int count)
+{
+	Store(member, values, GL_FLOAT, count);
+}
+
+void UniformBuffer::Set(const char* member, const int* values, unsigned int count)
+{
+	Store(member, values, GL_INT, count);
+}
+
+void UniformBuffer::Store(const char* member, const void* values, unsigned int componentType, unsigned int count)
+{
+	if (m_Shader.GetLinkCount() != m_LinkCount)
+		Repack();
+
+	const ShaderUniform* uniform = FindMember(member);
+	if (!uniform)
+		return;
+
+	unsigned int type = ShaderReflection::GetComponentType(uniform->Type);
+	ASSERT(type == componentType || (type == GL_BOOL && componentType == GL_INT));
+	ASSERT(count <= (unsigned int)uniform->Size);
+
+	// Kept as given, so the member can be packed again after a reload.
+	MemberValue& value = m_Values[member];
+	value.Type = uniform->Type;
+	value.Count = count;
+	const unsigned char* bytes = (const unsigned char*)values;
+	value.Data.assign(bytes, bytes + count * ShaderReflection::GetComponentCount(uniform->Type) * 4);
+	Write(*uniform, value);
+}
+
+const ShaderUniform* UniformBuffer::FindMember(const std::string& member) const
+{
+	const ShaderUniformBlock* block = m_Shader.GetUniformBlock(m_BlockName.c_str());
+	if (!block)
+	{
+		std::cout << "Warning: block '" << m_BlockName << "' doesn't exist in " << m_Shader.GetFilePath() << std::endl;
+		return nullptr;
+	}
+	for (const ShaderUniform& candidate : block->Members)
+	{
+		if (candidate.Name == member)
+			return &candidate;
+	}
+	std::cout << "Warning: '" << member << "' is not a member of block '" << m_BlockName << "'" << std::endl;
+	return nullptr;
+}
+
+void UniformBuffer::Repack()
+{
+	m_LinkCount = m_Shader.GetLinkCount();
+	const ShaderUniformBlock* block = m_Shader.GetUniformBlock(m_BlockName.c_str());
+	m_Data.assign(block ? block->DataSize : 0, 0);
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+	GLCall(glBufferData(GL_UNIFORM_BUFFER, m_Data.size(), m_Data.data(), GL_DYNAMIC_DRAW));
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+	if (!block)
+		return;
+
+	for (const auto& value : m_Values)
+	{
+		const ShaderUniform* uniform = FindMember(value.first);
+		if (!uniform)
+			continue;
+		// A member whose type changed in the reload has to be set again.
+		if (uniform->Type != value.second.Type || value.second.Count > (unsigned int)uniform->Size)
+		{
+			std::cout << "Warning: block member '" << value.first << "' changed type, set it again" << std::endl;
+			continue;
+		}
+		Write(*uniform, value.second);
+	}
+}
+
+void UniformBuffer::Write(const ShaderUniform& uniform, const MemberValue& value)
+{
+	// Matrices are written column by column; every column (and vector) is
+	// 4 bytes per component, the strides only add padding between them.
+	unsigned int components = ShaderReflection::GetComponentCount(uniform.Type);
+	unsigned int columns = 1;
+	if (uniform.Type == GL_FLOAT_MAT2) columns = 2;
+	if (uniform.Type == GL_FLOAT_MAT3) columns = 3;
+	if (uniform.Type == GL_FLOAT_MAT4) columns = 4;
+	unsigned int columnSize = components / columns * 4;
+
+	const unsigned char* src = value.Data.data();
+	for (unsigned int element = 0; element < value.Count; element++)
+	{
+		unsigned int offset = uniform.Offset + element * uniform.ArrayStride;
+		for (unsigned int column = 0; column < columns; column++)
+		{
+			unsigned int dst = offset + column * uniform.MatrixStride;
+			ASSERT(dst + columnSize <= m_Data.size());
+			memcpy(&m_Data[dst], src, columnSize);
+			src += columnSize;
+		}
+	}
+	m_Dirty = true;
+}
+
+void UniformBuffer::Bind(unsigned int binding)
+{
+	if (m_Shader.GetLinkCount() != m_LinkCount)
+		Repack();
+
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+	if (m_Dirty)
+	{
+		GLCall(glBufferSubData(GL_UNIFORM_BUFFER, 0, m_Data.size(), m_Data.data()));
+		m_Dirty = false;
+	}
+	GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_RendererID));
+}
+
+void UniformBuffer::Unbind() const
+{
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ShaderReflection.h"
+
+class Shader;
+
+// GL_UNIFORM_BUFFER packed from a shader's reflected block layout, so members
+// land at the offsets and strides the driver picked (std140 or not). The layout
+// is looked up on the shader rather than copied: when the shader is rebuilt,
+// e.g. by a hot reload, Bind repacks every member set so far against the new
+// layout.
+class UniformBuffer
+{
+private:
+	struct MemberValue
+	{
+		unsigned int Type; // Of the member when it was set
+		unsigned int Count;
+		std::vector<unsigned char> Data; // Tightly packed, as passed to Set
+	};
+
+	unsigned int m_RendererID;
+	const Shader& m_Shader;
+	std::string m_BlockName;
+	unsigned int m_LinkCount; // Shader link the data is packed for
+	std::unordered_map<std::string, MemberValue> m_Values;
+	std::vector<unsigned char> m_Data;
+	bool m_Dirty;
+public:
+	// The shader must outlive the buffer.
+	UniformBuffer(const Shader& shader, const char* block);
+	~UniformBuffer();
+
+	// values holds count tightly packed elements of the member's type.
+	void Set(const char* member, const float* values, unsigned int count = 1);
+	void Set(const char* member, const int* values, unsigned int count = 1);
+
+	// Uploads pending changes and binds the buffer to the given binding point.
+	void Bind(unsigned int binding);
+	void Unbind() const;
+
+	inline unsigned int GetSize() const { return (unsigned int)m_Data.size(); }
+private:
+	void Store(const char* member, const void* values, unsigned int componentType, unsigned int count);
+	const ShaderUniform* FindMember(const std::string& member) const;
+	// Packs every stored value against the shader's current block layout.
+	void Repack();
+	void Write(const ShaderUniform& uniform, const MemberValue& value);
+};
@@ -1,5 +1,6 @@
 #include "VertexArray.h"
 #include "Renderer.h"
+#include "Shader.h"
 #include "VertexBufferLayout.h"
 
 
@@ -14,7 +15,7 @@ VertexArray::~VertexArray()
 	GLCall(glDeleteVertexArrays(1, &m_RendererID));
 }
 
-void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
+void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, Shader* shader)
 {
 
 	Bind();
@@ -29,6 +30,9 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 
 		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
 	}
+
+	if (shader)
+		shader->AddLayout(layout);
 }
 
 void VertexArray::Bind() const
@@ -9,6 +9,7 @@
 //#include "VertexBufferLayout.h"
 
 class VertexBufferLayout; // Nao precisamos do header.
+class Shader;
 
 class VertexArray
 {
@@ -19,7 +20,9 @@ public:
 	VertexArray();
 	~VertexArray();
 
-	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	// With a shader, the layout is checked against its attributes now and
+	// again whenever the shader is rebuilt.
+	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, Shader* shader = nullptr);
 
 	void Bind() const;
 	void Unbind() const;